@@ -19,12 +19,31 @@ LOG_MODULE_REGISTER(context_storage, CONFIG_APP_LOG_LEVEL);
 
 #define FLASH_ERASE_BLOCK	4096U
 
-#define STORAGE_FORMAT_REV    0x01
+#define STORAGE_FORMAT_REV    0x02
+/* One pattern slot per mode of the former led_player_mode enum */
+#define STORAGE_FORMAT_REV_V1 0x01
+#define STORAGE_V1_PATTERN_SLOTS	5U
 
 /////////////////////////////////////
 // Local variables declarations
 /////////////////////////////////////
 
+/**< @brief Data container of format revision 1 >*/
+struct context_data_v1 {
+	char magic[sizeof(CONTEXT_MAGIC_WORD)];
+	uint32_t mode;
+	uint32_t brightness;
+	uint32_t pattern_context[STORAGE_V1_PATTERN_SLOTS];
+	uint32_t format_revision;
+	uint32_t crc32;
+} __attribute__((packed));
+
+/**< @brief Flash content, read before its revision is known >*/
+union context_image {
+	struct context_data current;
+	struct context_data_v1 v1;
+};
+
 /////////////////////////////////////
 // Local function declarations
 /////////////////////////////////////
@@ -47,6 +66,18 @@ static bool is_crc_valid(struct context_data *data);
 
 static void set_default_values(struct context_data *data);
 
+/**
+ * @brief Upgrade a format revision 1 container
+ * @details Patterns keep the order of the former mode enum, so slot i of
+ *          revision 1 is slot i of the registered patterns. Slots beyond
+ *          CONFIG_APP_CONTEXT_PATTERN_SLOTS are dropped, new ones are 0.
+ *
+ * @param[in] old: container read from flash
+ * @param[out] data: upgraded container
+ * @return bool true if old is a valid revision 1 container
+ */
+static bool migrate_v1(const struct context_data_v1 *old, struct context_data *data);
+
 /////////////////////////////////////
 // Local functions definition
 /////////////////////////////////////
@@ -64,20 +95,38 @@ static bool is_crc_valid(struct context_data *data)
 {
 	uint32_t crc = crc32_ieee((void *)data, sizeof(struct context_data) - sizeof(uint32_t));
 	if (crc != data->crc32) {
-		LOG_ERR("CRC NOK");
 		return false;
 	}
 
 	return true;
 }
 
+static bool migrate_v1(const struct context_data_v1 *old, struct context_data *data)
+{
+	uint32_t crc = crc32_ieee((const void *)old, sizeof(struct context_data_v1) - sizeof(uint32_t));
+
+	if (crc != old->crc32 || old->format_revision != STORAGE_FORMAT_REV_V1) {
+		return false;
+	}
+
+	memcpy(data->magic, old->magic, sizeof(data->magic));
+	data->mode = old->mode;
+	data->brightness = old->brightness;
+	memset(data->pattern_context, 0, sizeof(data->pattern_context));
+	memcpy(data->pattern_context, old->pattern_context,
+	       MIN(sizeof(data->pattern_context), sizeof(old->pattern_context)));
+	data->format_revision = STORAGE_FORMAT_REV;
+
+	return true;
+}
+
 static void display_current_data(struct context_data *data)
 {
 	LOG_INF(" ------ [Context storage] ------");
 	LOG_INF("| magic %s", data->magic);
 	LOG_INF("| mode %d", data->mode);
 	LOG_INF("| brightness %d", data->brightness);
-	for (int i = 0; i < LED_PLAYER_MODE_MAX; i++) {
+	for (int i = 0; i < CONTEXT_PATTERN_CONTEXT_MAX_SIZE; i++) {
 		LOG_INF("| pattern_context[%d]: %d", i, data->pattern_context[i]);
 	}
 	LOG_INF("| format_revision %d", data->format_revision);
@@ -86,7 +135,7 @@ static void display_current_data(struct context_data *data)
 
 static void set_default_values(struct context_data *data)
 {
-	data->mode = LED_PLAYER_MODE_UNICOLOR_WHITE;
+	data->mode = 0U;
 	data->brightness = 50U;
 }
 
@@ -97,6 +146,8 @@ static void set_default_values(struct context_data *data)
 int context_storage_read(struct context_data *data)
 {
 	const struct flash_area *flash_area;
+	union context_image image;
+	bool migrated = false;
 
 	if (!data) {
 		return -EFAULT;
@@ -110,22 +161,25 @@ int context_storage_read(struct context_data *data)
 		return -ENODEV;
 	}
 
-	if (flash_area_read(flash_area, 0, data, sizeof(struct context_data)) != 0) {
+	if (flash_area_read(flash_area, 0, &image, sizeof(union context_image)) != 0) {
 		LOG_ERR("Failed to read EEPROM data config");
 		flash_area_close(flash_area);
 		return -EIO;
 	}
 
 	/* Check magic word for data comissioning check */
-	if (!is_magic_number_valid(data)) {
+	if (!is_magic_number_valid(&image.current)) {
 		LOG_ERR("Wrong magic number");
 		flash_area_close(flash_area);
 		return -ENODATA;
 	}
 
-	display_current_data(data);
-	/* Check CRC value for data integrity check */
-	if (!is_crc_valid(data)) {
+	/* Check CRC value for data integrity check, an older format fails it */
+	if (is_crc_valid(&image.current)) {
+		*data = image.current;
+	} else if (migrate_v1(&image.v1, data)) {
+		migrated = true;
+	} else {
 		LOG_ERR("Failed to check CRC data device");
 		flash_area_close(flash_area);
 		return -EBADMSG;
@@ -133,6 +187,16 @@ int context_storage_read(struct context_data *data)
 
 	flash_area_close(flash_area);
 
+	if (migrated) {
+		LOG_INF("Context upgraded from revision %d", STORAGE_FORMAT_REV_V1);
+		/* Kept in RAM if the write fails, upgraded again at next boot */
+		if (context_storage_write(data)) {
+			LOG_WRN("Failed to store upgraded context");
+		}
+	} else {
+		display_current_data(data);
+	}
+
 	return 0;
 }
 
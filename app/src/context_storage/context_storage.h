@@ -7,16 +7,16 @@
 #ifndef CONTEXT_STORAGE_H
 #define CONTEXT_STORAGE_H
 
-#include <led_player/led_player.h>
+#include <stdint.h>
 
 #define CONTEXT_MAGIC_WORD "MAGICUCU"
-#define CONTEXT_PATTERN_CONTEXT_MAX_SIZE	4U
+#define CONTEXT_PATTERN_CONTEXT_MAX_SIZE	CONFIG_APP_CONTEXT_PATTERN_SLOTS
 
 struct context_data {
 	char magic[sizeof(CONTEXT_MAGIC_WORD)];
 	uint32_t mode;
     uint32_t brightness;
-	uint32_t pattern_context[LED_PLAYER_MODE_MAX];
+	uint32_t pattern_context[CONTEXT_PATTERN_CONTEXT_MAX_SIZE];
 	uint32_t format_revision;
 	uint32_t crc32;
 } __attribute__((packed));
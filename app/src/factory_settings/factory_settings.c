@@ -21,16 +21,43 @@ LOG_MODULE_REGISTER(factory_settings, CONFIG_APP_LOG_LEVEL);
 #define FACTORY_AREA_ID   FIXED_PARTITION_ID(FACTORY_PARTITION)
 #define FACTORY_SIZE      FIXED_PARTITION_SIZE(FACTORY_PARTITION)
 
-#define FACTORY_FORMAT_REV    0x01
+#define FACTORY_FORMAT_REV    0x02
+/* Before the chipset field */
+#define FACTORY_FORMAT_REV_V1 0x01
 
 /////////////////////////////////////
 // Local variables declarations
 /////////////////////////////////////
 
+/**< @brief Data container of format revision 1 >*/
+struct factory_data_v1 {
+	char magic[sizeof(FACTORY_MAGIC_WORD)];
+	uint32_t led_length;
+	uint32_t rgbw;
+	uint32_t format_revision;
+	uint32_t crc32;
+} __attribute__((packed));
+
+/**< @brief Flash content, read before its revision is known >*/
+union factory_image {
+	struct factory_data current;
+	struct factory_data_v1 v1;
+};
+
 /**< @brief Current data container >*/
 static struct factory_data m_factory_data = {
 	.led_length = 14U,
 	.rgbw = false,
+	.chipset = FACTORY_CHIPSET_WS2812,
+};
+
+/**< @brief Applies a new LED number without a reboot, if registered >*/
+static factory_led_length_cb_t m_led_length_cb;
+
+/**< @brief Shell names of enum factory_chipset >*/
+static const char *const m_chipset_names[FACTORY_CHIPSET_COUNT] = {
+	[FACTORY_CHIPSET_WS2812] = "ws2812",
+	[FACTORY_CHIPSET_APA102] = "apa102",
 };
 
 /////////////////////////////////////
@@ -53,6 +80,17 @@ static bool is_magic_number_valid(const struct factory_data *data);
  */
 static bool is_crc_valid(struct factory_data *data);
 
+/**
+ * @brief Upgrade a format revision 1 container
+ * @details The strip keeps its length and RGBW option, revision 1 only
+ *          drove WS2812 strips.
+ *
+ * @param[in] old: container read from flash
+ * @param[out] data: upgraded container
+ * @return bool true if old is a valid revision 1 container
+ */
+static bool migrate_v1(const struct factory_data_v1 *old, struct factory_data *data);
+
 /////////////////////////////////////
 // Local functions definition
 /////////////////////////////////////
@@ -70,19 +108,36 @@ static bool is_crc_valid(struct factory_data *data)
 {
 	uint32_t crc = crc32_ieee((void *)data, sizeof(struct factory_data) - sizeof(uint32_t));
 	if (crc != data->crc32) {
-		LOG_ERR("CRC NOK");
 		return false;
 	}
 
 	return true;
 }
 
+static bool migrate_v1(const struct factory_data_v1 *old, struct factory_data *data)
+{
+	uint32_t crc = crc32_ieee((const void *)old, sizeof(struct factory_data_v1) - sizeof(uint32_t));
+
+	if (crc != old->crc32 || old->format_revision != FACTORY_FORMAT_REV_V1) {
+		return false;
+	}
+
+	memcpy(data->magic, old->magic, sizeof(data->magic));
+	data->led_length = old->led_length;
+	data->rgbw = old->rgbw;
+	data->chipset = FACTORY_CHIPSET_WS2812;
+	data->format_revision = FACTORY_FORMAT_REV;
+
+	return true;
+}
+
 static void display_current_data(void)
 {
 	LOG_INF(" ------ [Factory settings] ------");
 	LOG_INF("| magic %s", m_factory_data.magic);
 	LOG_INF("| led_number %d", m_factory_data.led_length);
 	LOG_INF("| rgbw %d", m_factory_data.rgbw);
+	LOG_INF("| chipset %d", m_factory_data.chipset);
 	LOG_INF("| format_revision %d", m_factory_data.format_revision);
 	LOG_INF(" --------------------------------");
 }
@@ -137,6 +192,10 @@ static int set_led_number(const struct shell *sh, size_t argc, char **argv)
 			shell_error(sh, "Failed to write in memory");
 		} else {
 			shell_print(sh, "OK:%u", m_factory_data.led_length);
+			/* Resized live when the user of the strip can, else at next boot */
+			if (!m_led_length_cb || m_led_length_cb(value)) {
+				shell_warn(sh, "Applied at next boot");
+			}
 		}
 	}
 
@@ -187,6 +246,49 @@ int enable_rgbw(const struct shell *sh, size_t argc, char **argv)
 	return 0;
 }
 
+static int get_chipset(const struct shell *sh, size_t argc, char **argv)
+{
+	ARG_UNUSED(argc);
+	ARG_UNUSED(argv);
+
+	if (factory_settings_read()) {
+		shell_error(sh, "Failed to read memory");
+	} else if (m_factory_data.chipset >= FACTORY_CHIPSET_COUNT) {
+		shell_print(sh, "Chipset: unknown (%u)", m_factory_data.chipset);
+	} else {
+		shell_print(sh, "Chipset: %s", m_chipset_names[m_factory_data.chipset]);
+	}
+
+	return 0;
+}
+
+static int set_chipset(const struct shell *sh, size_t argc, char **argv)
+{
+	uint32_t value;
+
+	ARG_UNUSED(argc);
+
+	for (value = 0U; value < FACTORY_CHIPSET_COUNT; value++) {
+		if (strcmp(argv[1], m_chipset_names[value]) == 0) {
+			break;
+		}
+	}
+
+	if (value == FACTORY_CHIPSET_COUNT) {
+		shell_error(sh, "Unknown chipset %s (ws2812|apa102)", argv[1]);
+		return -EINVAL;
+	}
+
+	m_factory_data.chipset = value;
+	if (factory_settings_write(&m_factory_data)) {
+		shell_error(sh, "Failed to write in memory");
+	} else {
+		shell_print(sh, "OK:%s, applied at next boot", m_chipset_names[value]);
+	}
+
+	return 0;
+}
+
 SHELL_STATIC_SUBCMD_SET_CREATE(
 	m_sub_led_number,
 	SHELL_CMD(get, NULL, "Get LED number", get_led_number),
@@ -198,12 +300,18 @@ SHELL_STATIC_SUBCMD_SET_CREATE(
 	SHELL_CMD(off, NULL, "Disable RGBW", disable_rgbw),
 	SHELL_CMD(on, NULL, "Enable TGBW", enable_rgbw),
 	SHELL_SUBCMD_SET_END);
+SHELL_STATIC_SUBCMD_SET_CREATE(
+	m_sub_chipset,
+	SHELL_CMD(get, NULL, "Get LED chipset", get_chipset),
+	SHELL_CMD_ARG(set, NULL, "Set LED chipset: ws2812|apa102", set_chipset, 2, 0),
+	SHELL_SUBCMD_SET_END);
 
 
 /** @brief Lowpower shell categorie */
 SHELL_STATIC_SUBCMD_SET_CREATE(sub_app,
 						 SHELL_CMD_ARG(led_number, &m_sub_led_number, "Get/set LED number", NULL, 1, 1),
 						 SHELL_CMD_ARG(rgbw, &m_sub_rgbw, "Enable/get RGBW", NULL, 1, 1),
+						 SHELL_CMD_ARG(chipset, &m_sub_chipset, "Get/set LED chipset", NULL, 1, 1),
 			       SHELL_SUBCMD_SET_END);
 
 SHELL_CMD_REGISTER(factory, &sub_app, "Factory settings", NULL);
@@ -217,6 +325,9 @@ SHELL_CMD_REGISTER(factory, &sub_app, "Factory settings", NULL);
 int factory_settings_read(void)
 {
 	const struct flash_area *flash_area;
+	/* Defaults are kept unless the stored data is valid */
+	union factory_image image;
+	bool migrated = false;
 
 	if (flash_area_open(FACTORY_AREA_ID, &flash_area) != 0) {
 		LOG_ERR("Failed to open eeprom");
@@ -224,22 +335,25 @@ int factory_settings_read(void)
 		return -ENODEV;
 	}
 
-	if (flash_area_read(flash_area, 0, &m_factory_data, sizeof(struct factory_data)) != 0) {
+	if (flash_area_read(flash_area, 0, &image, sizeof(union factory_image)) != 0) {
 		LOG_ERR("Failed to read EEPROM data config");
 		flash_area_close(flash_area);
 		return -EIO;
 	}
 
 	/* Check magic word for data comissioning check */
-	if (!is_magic_number_valid(&m_factory_data)) {
+	if (!is_magic_number_valid(&image.current)) {
 		LOG_ERR("Wrong magic number");
 		flash_area_close(flash_area);
 		return -ENODATA;
 	}
 
-	display_current_data();
-	/* Check CRC value for data integrity check */
-	if (!is_crc_valid(&m_factory_data)) {
+	/* Check CRC value for data integrity check, an older format fails it */
+	if (is_crc_valid(&image.current)) {
+		m_factory_data = image.current;
+	} else if (migrate_v1(&image.v1, &m_factory_data)) {
+		migrated = true;
+	} else {
 		LOG_ERR("Failed to check CRC data device");
 		flash_area_close(flash_area);
 		return -EBADMSG;
@@ -247,6 +361,16 @@ int factory_settings_read(void)
 
 	flash_area_close(flash_area);
 
+	if (migrated) {
+		LOG_INF("Factory data upgraded from revision %d", FACTORY_FORMAT_REV_V1);
+		/* Kept in RAM if the write fails, upgraded again at next boot */
+		if (factory_settings_write(&m_factory_data)) {
+			LOG_WRN("Failed to store upgraded factory data");
+		}
+	} else {
+		display_current_data();
+	}
+
 	return 0;
 }
 
@@ -293,3 +417,8 @@ struct factory_data *factory_settings_get(void)
 {
 	return &m_factory_data;
 }
+
+void factory_settings_set_led_length_cb(factory_led_length_cb_t cb)
+{
+	m_led_length_cb = cb;
+}
@@ -9,14 +9,32 @@
 
 #define FACTORY_MAGIC_WORD "MAGICOCO"
 
+/**< @brief LED chipset protocol of the strip >*/
+enum factory_chipset {
+	/* WS2812 and its clones, SK6812 when rgbw is set */
+	FACTORY_CHIPSET_WS2812 = 0,
+	/* APA102 and SK9822, clocked SPI with a global brightness field */
+	FACTORY_CHIPSET_APA102,
+	FACTORY_CHIPSET_COUNT,
+};
+
 struct factory_data {
 	char magic[sizeof(FACTORY_MAGIC_WORD)];
 	uint32_t led_length;
     uint32_t rgbw;
+	uint32_t chipset;
 	uint32_t format_revision;
 	uint32_t crc32;
 } __attribute__((packed));
 
+/**
+ * @brief Apply a new LED number
+ *
+ * @param[in] led_length: LED number, already stored
+ * @return int 0 if applied now, negative if applied at next boot
+ */
+typedef int (*factory_led_length_cb_t)(uint32_t led_length);
+
 /**
  * @brief Read config data
  * @details Read EEPROM and copy values into static memory
@@ -43,4 +61,13 @@ int factory_settings_write(struct factory_data *data);
 
 struct factory_data *factory_settings_get(void);
 
+/**
+ * @brief Register the function applying a LED number set from the shell
+ * @details Factory settings do not depend on their users: the LED player
+ *          registers itself to resize the strip without a reboot.
+ *
+ * @param[in] cb: function to call, NULL to apply at next boot only
+ */
+void factory_settings_set_led_length_cb(factory_led_length_cb_t cb);
+
 #endif /* FACTORY_SETTINGS_H */
\ No newline at end of file
@@ -0,0 +1,213 @@
+/*
+ * Copyright (c) 2024 Romain Pelletant
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#include <zephyr/kernel.h>
+#include <zephyr/device.h>
+#include <zephyr/drivers/spi.h>
+#include <zephyr/drivers/led_strip.h>
+#include <string.h>
+
+#include <led_player/backend/backend.h>
+#include <led_player/frame_arena.h>
+
+#include <zephyr/logging/log.h>
+LOG_MODULE_REGISTER(apa102_backend, CONFIG_APP_LOG_LEVEL);
+
+/*
+ * APA102 and SK9822 strip, driven here rather than by the Zephyr driver so
+ * that the 5-bit global brightness of each LED frame can be set: dimming in
+ * the LED keeps the 8 bits of color resolution that software scaling loses.
+ */
+
+#define APA102_NODE		DT_ALIAS(led_strip_apa102)
+
+#define APA102_SPI_OPERATION	(SPI_OP_MODE_MASTER | SPI_TRANSFER_MSB | SPI_WORD_SET(8))
+
+/**< @brief 32 zero bits before the first LED frame >*/
+#define APA102_START_LEN	4U
+/**< @brief LED frame: header and global brightness, then blue, green and red >*/
+#define APA102_LED_LEN		4U
+#define APA102_LED_HEADER	0xE0U
+#define APA102_BRIGHTNESS_MAX	31U
+/**< @brief End frame: 32 zero bits latch SK9822, then one bit per two LEDs lets
+ * APA102 data reach the end of the chain >*/
+#define APA102_END_LEN(_length)	(4U + DIV_ROUND_UP(_length, 16U))
+
+/////////////////////////////////////
+// Local variables declarations
+/////////////////////////////////////
+
+struct apa102_data {
+	/* Start frame, LED frames and end frame, sent as is */
+	uint8_t *buf;
+	size_t length;
+	/* Global brightness of the next encoded LED frames */
+	uint8_t brightness;
+};
+
+static const struct spi_dt_spec m_bus = SPI_DT_SPEC_GET(APA102_NODE, APA102_SPI_OPERATION, 0);
+
+static struct apa102_data m_data = {
+	.brightness = APA102_BRIGHTNESS_MAX,
+};
+
+/////////////////////////////////////
+// Local function declarations
+/////////////////////////////////////
+
+/////////////////////////////////////
+// Local functions definition
+/////////////////////////////////////
+
+static size_t apa102_buf_len(size_t length)
+{
+	return APA102_START_LEN + length * APA102_LED_LEN + APA102_END_LEN(length);
+}
+
+static void apa102_encode(const struct device *dev, size_t offset,
+			  const struct led_rgb *pixels, size_t count)
+{
+	struct apa102_data *data = dev->data;
+	uint8_t *frame = &data->buf[APA102_START_LEN + offset * APA102_LED_LEN];
+	const uint8_t header = APA102_LED_HEADER | data->brightness;
+
+	for (size_t i = 0; i < count; i++) {
+		frame[0] = header;
+		frame[1] = pixels[i].b;
+		frame[2] = pixels[i].g;
+		frame[3] = pixels[i].r;
+		frame += APA102_LED_LEN;
+	}
+}
+
+static int apa102_send(const struct device *dev)
+{
+	struct apa102_data *data = dev->data;
+	const struct spi_buf buf = {
+		.buf = data->buf,
+		.len = apa102_buf_len(data->length),
+	};
+	const struct spi_buf_set tx = {
+		.buffers = &buf,
+		.count = 1,
+	};
+
+	return spi_write_dt(&m_bus, &tx);
+}
+
+static int apa102_update_rgb(const struct device *dev, struct led_rgb *pixels, size_t num_pixels)
+{
+	struct apa102_data *data = dev->data;
+
+	if (num_pixels > data->length) {
+		return -ERANGE;
+	}
+
+	apa102_encode(dev, 0U, pixels, num_pixels);
+
+	return apa102_send(dev);
+}
+
+static size_t apa102_length(const struct device *dev)
+{
+	const struct apa102_data *data = dev->data;
+
+	return data->length;
+}
+
+static int apa102_set_length(const struct device *dev, size_t length)
+{
+	struct apa102_data *data = dev->data;
+	uint8_t *buf;
+
+	if (length == 0U) {
+		return -EINVAL;
+	}
+
+	buf = frame_arena_realloc(data->buf, apa102_buf_len(length));
+	if (!buf) {
+		return -ENOMEM;
+	}
+
+	data->buf = buf;
+	data->length = length;
+
+	/* Start and end frames never change, LEDs start off */
+	memset(buf, 0, APA102_START_LEN);
+	for (size_t i = 0; i < length; i++) {
+		memcpy(&buf[APA102_START_LEN + i * APA102_LED_LEN],
+		       (const uint8_t[]) { APA102_LED_HEADER, 0U, 0U, 0U }, APA102_LED_LEN);
+	}
+	memset(&buf[APA102_START_LEN + length * APA102_LED_LEN], 0, APA102_END_LEN(length));
+
+	return 0;
+}
+
+static int apa102_encode_span(const struct device *dev, size_t offset,
+			      const struct led_rgb *pixels, size_t count)
+{
+	struct apa102_data *data = dev->data;
+
+	if (offset > data->length || count > data->length - offset) {
+		return -ERANGE;
+	}
+
+	apa102_encode(dev, offset, pixels, count);
+
+	return 0;
+}
+
+/* Clocked SPI is fast enough to send the frame before returning */
+static int apa102_flush_async(const struct device *dev, led_strip_update_cb_t cb, void *user_data)
+{
+	int rc = apa102_send(dev);
+
+	if (rc == 0 && cb) {
+		cb(dev, rc, user_data);
+	}
+
+	return rc;
+}
+
+static int apa102_set_brightness(const struct device *dev, uint8_t level)
+{
+	struct apa102_data *data = dev->data;
+
+	data->brightness = MIN(level, APA102_BRIGHTNESS_MAX);
+
+	return 0;
+}
+
+static int apa102_init(const struct device *dev)
+{
+	if (!spi_is_ready_dt(&m_bus)) {
+		LOG_ERR("SPI device %s not ready", m_bus.bus->name);
+		return -ENODEV;
+	}
+
+	return apa102_set_length(dev, DT_PROP(APA102_NODE, chain_length));
+}
+
+static DEVICE_API(led_strip, m_api) = {
+	.update_rgb = apa102_update_rgb,
+	.length = apa102_length,
+	.set_length = apa102_set_length,
+	.encode_span = apa102_encode_span,
+	.flush_async = apa102_flush_async,
+};
+
+DEVICE_DEFINE(apa102_backend, "apa102_backend", apa102_init, NULL, &m_data, NULL,
+	      POST_KERNEL, CONFIG_LED_STRIP_INIT_PRIORITY, &m_api);
+
+/////////////////////////////////////
+// Functions definition
+/////////////////////////////////////
+
+const struct led_backend led_backend_apa102 = {
+	.name = "apa102",
+	.dev = DEVICE_GET(apa102_backend),
+	.brightness_levels = APA102_BRIGHTNESS_MAX,
+	.set_brightness = apa102_set_brightness,
+};
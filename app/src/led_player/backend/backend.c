@@ -0,0 +1,98 @@
+/*
+ * Copyright (c) 2024 Romain Pelletant
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#include <zephyr/kernel.h>
+
+#include <factory_settings/factory_settings.h>
+#include <led_player/backend/backend.h>
+
+#include <zephyr/logging/log.h>
+LOG_MODULE_REGISTER(led_backend, CONFIG_APP_LOG_LEVEL);
+
+#define WS2812_NODE		DT_ALIAS(led_strip)
+#define SK6812_NODE		DT_ALIAS(led_strip_rgbw)
+
+/////////////////////////////////////
+// Local variables declarations
+/////////////////////////////////////
+
+static const struct led_backend_ws2812 m_ws2812_strip =
+	LED_BACKEND_WS2812_DT(WS2812_NODE, "ws2812b");
+
+static const struct led_backend m_ws2812 = {
+	.name = "ws2812",
+	.dev = DEVICE_DT_GET(WS2812_NODE),
+	.ws2812 = &m_ws2812_strip,
+	.ws2812_count = 1U,
+};
+
+#if defined(CONFIG_APP_LED_BACKEND_GROUP)
+/* Defined in group.c, several WS2812 strips seen as one */
+extern const struct led_backend led_backend_group;
+#define WS2812_BACKEND		(&led_backend_group)
+#else
+#define WS2812_BACKEND		(&m_ws2812)
+#endif
+
+/* SK6812 RGBW speaks WS2812, its node only differs by the color mapping */
+#if DT_NODE_HAS_STATUS(SK6812_NODE, okay)
+static const struct led_backend_ws2812 m_sk6812_strip =
+	LED_BACKEND_WS2812_DT(SK6812_NODE, "sk6812");
+
+static const struct led_backend m_sk6812 = {
+	.name = "sk6812",
+	.dev = DEVICE_DT_GET(SK6812_NODE),
+	.ws2812 = &m_sk6812_strip,
+	.ws2812_count = 1U,
+};
+#define SK6812_BACKEND		(&m_sk6812)
+#else
+#define SK6812_BACKEND		NULL
+#endif
+
+#if defined(CONFIG_APP_LED_BACKEND_APA102)
+/* Defined in apa102.c */
+extern const struct led_backend led_backend_apa102;
+#define APA102_BACKEND		(&led_backend_apa102)
+#else
+#define APA102_BACKEND		NULL
+#endif
+
+/////////////////////////////////////
+// Local function declarations
+/////////////////////////////////////
+
+/////////////////////////////////////
+// Local functions definition
+/////////////////////////////////////
+
+/////////////////////////////////////
+// Functions definition
+/////////////////////////////////////
+
+const struct led_backend *led_backend_select(uint32_t chipset, bool rgbw)
+{
+	const struct led_backend *backend = NULL;
+
+	switch (chipset) {
+	case FACTORY_CHIPSET_WS2812:
+		backend = rgbw ? SK6812_BACKEND : WS2812_BACKEND;
+		break;
+	case FACTORY_CHIPSET_APA102:
+		backend = APA102_BACKEND;
+		break;
+	default:
+		break;
+	}
+
+	if (!backend) {
+		LOG_WRN("No strip for chipset %u%s, using ws2812", chipset, rgbw ? " rgbw" : "");
+		backend = &m_ws2812;
+	}
+
+	LOG_INF("LED backend %s", backend->name);
+
+	return backend;
+}
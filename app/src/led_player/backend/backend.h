@@ -0,0 +1,63 @@
+/*
+ * Copyright (c) 2024 Romain Pelletant
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef LED_BACKEND_H
+#define LED_BACKEND_H
+
+#include <zephyr/kernel.h>
+#include <zephyr/device.h>
+
+/**< @brief Devicetree settings of a WS2812 strip, checked by "ledstrip timing" >*/
+struct led_backend_ws2812 {
+	const char *node;
+	/* Chipset of ws2812_timing_specs the strip is expected to be */
+	const char *spec;
+	uint32_t max_frequency;
+	uint32_t reset_delay;
+	uint8_t one_frame;
+	uint8_t zero_frame;
+	uint8_t num_colors;
+};
+
+/**< @brief Fill struct led_backend_ws2812 from a worldsemi,ws2812-spi node >*/
+#define LED_BACKEND_WS2812_DT(_node, _spec)					\
+	{									\
+		.node = DT_NODE_FULL_NAME(_node),				\
+		.spec = (_spec),						\
+		.max_frequency = DT_PROP(_node, spi_max_frequency),		\
+		.reset_delay = DT_PROP(_node, reset_delay),			\
+		.one_frame = DT_PROP(_node, spi_one_frame),			\
+		.zero_frame = DT_PROP(_node, spi_zero_frame),			\
+		.num_colors = DT_PROP_LEN(_node, color_mapping),		\
+	}
+
+/**< @brief LED chipset protocol and the strip device speaking it >*/
+struct led_backend {
+	const char *name;
+	/* Strip driven through the led_strip API */
+	const struct device *dev;
+	/* Steps of the brightness applied by the LEDs themselves, 0 without */
+	uint8_t brightness_levels;
+	/* Set the LED brightness (0 to brightness_levels) of the next encoded pixels,
+	 * NULL when pixels are scaled in software only */
+	int (*set_brightness)(const struct device *dev, uint8_t level);
+	/* WS2812 strips behind dev, none for clocked chipsets */
+	const struct led_backend_ws2812 *ws2812;
+	size_t ws2812_count;
+};
+
+/**
+ * @brief Pick the strip backend from factory settings
+ * @details Falls back to the WS2812 backend when the devicetree has no strip
+ *          for the requested chipset.
+ *
+ * @param[in] chipset: enum factory_chipset
+ * @param[in] rgbw: strip has a white channel
+ * @return const struct led_backend * never NULL
+ */
+const struct led_backend *led_backend_select(uint32_t chipset, bool rgbw);
+
+#endif /* LED_BACKEND_H */
@@ -0,0 +1,440 @@
+/*
+ * Copyright (c) 2024 Romain Pelletant
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#include <zephyr/kernel.h>
+#include <zephyr/device.h>
+#include <zephyr/drivers/led_strip.h>
+
+#include <led_player/backend/backend.h>
+
+#include <zephyr/logging/log.h>
+LOG_MODULE_REGISTER(led_group, CONFIG_APP_LOG_LEVEL);
+
+/*
+ * One logical strip made of the strips listed in the led-strips property of
+ * the zephyr,user node, as consecutive ranges in list order. Spans and runs
+ * are split at the range boundaries, frames are handed to every strip before
+ * waiting for any, so strips on separate buses send at the same time.
+ */
+
+#define GROUP_NODE		DT_PATH(zephyr_user)
+
+/////////////////////////////////////
+// Local variables declarations
+/////////////////////////////////////
+
+struct group_child {
+	const struct device *dev;
+	/* chain-length, the logical length is split in proportion */
+	size_t weight;
+	/* Range of the logical strip driven by this strip */
+	size_t start;
+	size_t length;
+};
+
+struct group_data {
+	size_t length;
+	/* Available when no child is still sending a frame of the group */
+	struct k_sem idle;
+	/* Children still sending the frame, plus one while they are started */
+	atomic_t pending;
+	atomic_t result;
+	led_strip_update_cb_t cb;
+	void *user_data;
+};
+
+#define GROUP_CHILD(_node, _prop, _idx)							\
+	{										\
+		.dev = DEVICE_DT_GET(DT_PHANDLE_BY_IDX(_node, _prop, _idx)),		\
+		.weight = DT_PROP_BY_PHANDLE_IDX(_node, _prop, _idx, chain_length),	\
+	},
+
+static struct group_child m_children[] = {
+	DT_FOREACH_PROP_ELEM(GROUP_NODE, led_strips, GROUP_CHILD)
+};
+
+#define GROUP_CHILD_WS2812(_node, _prop, _idx)						\
+	LED_BACKEND_WS2812_DT(DT_PHANDLE_BY_IDX(_node, _prop, _idx), "ws2812b"),
+
+static const struct led_backend_ws2812 m_children_ws2812[] = {
+	DT_FOREACH_PROP_ELEM(GROUP_NODE, led_strips, GROUP_CHILD_WS2812)
+};
+
+static struct group_data m_data;
+
+/////////////////////////////////////
+// Local function declarations
+/////////////////////////////////////
+
+/////////////////////////////////////
+// Local functions definition
+/////////////////////////////////////
+
+/* Child driving logical pixel pos, pos < length */
+static struct group_child *group_child_at(size_t pos)
+{
+	size_t i = ARRAY_SIZE(m_children) - 1U;
+
+	while (pos < m_children[i].start) {
+		i--;
+	}
+
+	return &m_children[i];
+}
+
+static size_t format_size(enum led_strip_format format)
+{
+	switch (format) {
+	case LED_STRIP_FORMAT_RGB565:
+		return sizeof(uint16_t);
+	case LED_STRIP_FORMAT_INDEX8:
+		return sizeof(uint8_t);
+	default:
+		return sizeof(struct led_rgb);
+	}
+}
+
+/* Last child done: the next frame may start, then the caller is told */
+static void group_done(const struct device *dev)
+{
+	struct group_data *data = dev->data;
+	led_strip_update_cb_t cb = data->cb;
+	void *user_data = data->user_data;
+	int result = atomic_get(&data->result);
+
+	k_sem_give(&data->idle);
+
+	if (cb) {
+		cb(dev, result, user_data);
+	}
+}
+
+static void group_child_done(const struct device *dev, int result, void *user_data)
+{
+	const struct device *group = user_data;
+	struct group_data *data = group->data;
+
+	ARG_UNUSED(dev);
+
+	if (result) {
+		atomic_cas(&data->result, 0, result);
+	}
+
+	if (atomic_dec(&data->pending) == 1) {
+		group_done(group);
+	}
+}
+
+/*
+ * Send the first num_pixels of the frame: every child is started before any
+ * is waited for. Once a child is started, errors of the others go to the
+ * callback.
+ */
+static int group_flush(const struct device *dev, size_t num_pixels,
+		       led_strip_update_cb_t cb, void *user_data)
+{
+	struct group_data *data = dev->data;
+	int rc = 0;
+
+	if (num_pixels == 0U || num_pixels > data->length) {
+		return -ERANGE;
+	}
+
+	k_sem_take(&data->idle, K_FOREVER);
+
+	data->cb = cb;
+	data->user_data = user_data;
+	atomic_set(&data->result, 0);
+	atomic_set(&data->pending, 1);
+
+	for (size_t i = 0; i < ARRAY_SIZE(m_children) && m_children[i].start < num_pixels; i++) {
+		const struct group_child *child = &m_children[i];
+		const size_t count = MIN(child->length, num_pixels - child->start);
+		int err;
+
+		atomic_inc(&data->pending);
+		if (count == child->length) {
+			err = led_strip_flush_async(child->dev, group_child_done, (void *)dev);
+		} else {
+			err = led_strip_flush_prefix_async(child->dev, count, group_child_done,
+							   (void *)dev);
+		}
+
+		if (err) {
+			atomic_dec(&data->pending);
+			if (i == 0U) {
+				rc = err;
+				break;
+			}
+			atomic_cas(&data->result, 0, err);
+		}
+	}
+
+	if (rc) {
+		k_sem_give(&data->idle);
+		return rc;
+	}
+
+	if (atomic_dec(&data->pending) == 1) {
+		group_done(dev);
+	}
+
+	return 0;
+}
+
+static int group_update_rgb(const struct device *dev, struct led_rgb *pixels, size_t num_pixels)
+{
+	struct group_data *data = dev->data;
+
+	if (num_pixels > data->length) {
+		return -ERANGE;
+	}
+
+	for (size_t i = 0; i < ARRAY_SIZE(m_children) && m_children[i].start < num_pixels; i++) {
+		const struct group_child *child = &m_children[i];
+		int err = led_strip_update_rgb(child->dev, &pixels[child->start],
+					       MIN(child->length, num_pixels - child->start));
+
+		if (err) {
+			return err;
+		}
+	}
+
+	return 0;
+}
+
+static size_t group_length(const struct device *dev)
+{
+	const struct group_data *data = dev->data;
+
+	return data->length;
+}
+
+static int group_set_length(const struct device *dev, size_t length)
+{
+	struct group_data *data = dev->data;
+	size_t lengths[ARRAY_SIZE(m_children)];
+	size_t total = 0U;
+	size_t weight = 0U;
+	size_t start = 0U;
+
+	if (length < ARRAY_SIZE(m_children)) {
+		return -EINVAL;
+	}
+
+	for (size_t i = 0; i < ARRAY_SIZE(m_children); i++) {
+		total += m_children[i].weight;
+	}
+
+	/* Cumulative split, the ranges add up to length exactly */
+	for (size_t i = 0; i < ARRAY_SIZE(m_children); i++) {
+		size_t end;
+
+		weight += m_children[i].weight;
+		end = (uint64_t) length * weight / total;
+		/* Every child keeps at least one pixel */
+		end = CLAMP(end, start + 1U, length - (ARRAY_SIZE(m_children) - 1U - i));
+		lengths[i] = end - start;
+		start = end;
+	}
+
+	for (size_t i = 0; i < ARRAY_SIZE(m_children); i++) {
+		int err = led_strip_set_length(m_children[i].dev, lengths[i]);
+
+		if (err) {
+			/* Children already resized go back to their range, unset at init */
+			while (i-- > 0) {
+				const struct group_child *child = &m_children[i];
+				int rc = child->length ? led_strip_set_length(child->dev, child->length) : 0;
+
+				if (rc) {
+					LOG_ERR("%s: length %zu not restored (%d)", child->dev->name,
+						child->length, rc);
+				}
+			}
+			return err;
+		}
+	}
+
+	start = 0U;
+	for (size_t i = 0; i < ARRAY_SIZE(m_children); i++) {
+		m_children[i].start = start;
+		m_children[i].length = lengths[i];
+		start += lengths[i];
+	}
+
+	data->length = length;
+
+	return 0;
+}
+
+static int group_encode_span(const struct device *dev, size_t offset,
+			     const struct led_rgb *pixels, size_t count)
+{
+	struct group_data *data = dev->data;
+
+	if (offset > data->length) {
+		return -ERANGE;
+	}
+
+	/* Empty spans still reach a child, so that an unsupported call reports -ENOSYS */
+	if (count == 0U) {
+		return led_strip_encode_span(m_children[0].dev, 0U, pixels, 0U);
+	}
+
+	return led_strip_encode_span_format(dev, offset, LED_STRIP_FORMAT_RGB, pixels, count,
+					    NULL);
+}
+
+static int group_encode_span_format(const struct device *dev, size_t offset,
+				    enum led_strip_format format, const void *pixels,
+				    size_t count, const struct led_rgb *palette)
+{
+	struct group_data *data = dev->data;
+	const uint8_t *src = pixels;
+	const size_t size = format_size(format);
+
+	if (offset > data->length || count > data->length - offset) {
+		return -ERANGE;
+	}
+
+	if (count == 0U) {
+		return led_strip_encode_span_format(m_children[0].dev, 0U, format, pixels, 0U,
+						    palette);
+	}
+
+	while (count) {
+		const struct group_child *child = group_child_at(offset);
+		const size_t n = MIN(count, child->start + child->length - offset);
+		int err;
+
+		if (format == LED_STRIP_FORMAT_RGB) {
+			err = led_strip_encode_span(child->dev, offset - child->start,
+						    (const struct led_rgb *)src, n);
+		} else {
+			err = led_strip_encode_span_format(child->dev, offset - child->start,
+							   format, src, n, palette);
+		}
+		if (err) {
+			return err;
+		}
+
+		src += n * size;
+		offset += n;
+		count -= n;
+	}
+
+	return 0;
+}
+
+static int group_encode_runs(const struct device *dev, size_t offset,
+			     const struct led_strip_run *runs, size_t num_runs)
+{
+	struct group_data *data = dev->data;
+	size_t left;
+
+	if (offset > data->length) {
+		return -ERANGE;
+	}
+
+	left = data->length - offset;
+	for (size_t i = 0; i < num_runs; i++) {
+		if (runs[i].length > left) {
+			return -ERANGE;
+		}
+		left -= runs[i].length;
+	}
+
+	if (num_runs == 0U) {
+		return led_strip_encode_runs(m_children[0].dev, 0U, runs, 0U);
+	}
+
+	/* A run over a boundary is encoded as one run on each side */
+	for (size_t i = 0; i < num_runs; i++) {
+		struct led_strip_run part = runs[i];
+		size_t length = runs[i].length;
+
+		while (length) {
+			const struct group_child *child = group_child_at(offset);
+			int err;
+
+			part.length = MIN(length, child->start + child->length - offset);
+			err = led_strip_encode_runs(child->dev, offset - child->start, &part, 1U);
+			if (err) {
+				return err;
+			}
+
+			offset += part.length;
+			length -= part.length;
+		}
+	}
+
+	return 0;
+}
+
+static int group_flush_async(const struct device *dev, led_strip_update_cb_t cb, void *user_data)
+{
+	struct group_data *data = dev->data;
+
+	return group_flush(dev, data->length, cb, user_data);
+}
+
+static int group_flush_prefix_async(const struct device *dev, size_t num_pixels,
+				    led_strip_update_cb_t cb, void *user_data)
+{
+	/* Probed with 0 pixels: answer for the children */
+	if (num_pixels == 0U) {
+		return led_strip_flush_prefix_async(m_children[0].dev, 0U, cb, user_data);
+	}
+
+	return group_flush(dev, num_pixels, cb, user_data);
+}
+
+static int group_init(const struct device *dev)
+{
+	struct group_data *data = dev->data;
+	size_t length = 0U;
+
+	k_sem_init(&data->idle, 1, 1);
+
+	for (size_t i = 0; i < ARRAY_SIZE(m_children); i++) {
+		if (!device_is_ready(m_children[i].dev)) {
+			LOG_ERR("LED strip %s not ready", m_children[i].dev->name);
+			return -ENODEV;
+		}
+		length += m_children[i].weight;
+	}
+
+	LOG_INF("%zu strips, %zu LEDs", ARRAY_SIZE(m_children), length);
+
+	return group_set_length(dev, length);
+}
+
+/* A rotation crosses the strip boundaries: rotate_async is left out, frames are rendered */
+static DEVICE_API(led_strip, m_api) = {
+	.update_rgb = group_update_rgb,
+	.length = group_length,
+	.set_length = group_set_length,
+	.encode_span = group_encode_span,
+	.encode_runs = group_encode_runs,
+	.encode_span_format = group_encode_span_format,
+	.flush_async = group_flush_async,
+	.flush_prefix_async = group_flush_prefix_async,
+};
+
+/* After the strips it is made of */
+DEVICE_DEFINE(led_group, "led_group", group_init, NULL, &m_data, NULL,
+	      APPLICATION, CONFIG_APPLICATION_INIT_PRIORITY, &m_api);
+
+/////////////////////////////////////
+// Functions definition
+/////////////////////////////////////
+
+const struct led_backend led_backend_group = {
+	.name = "ws2812 group",
+	.dev = DEVICE_GET(led_group),
+	.ws2812 = m_children_ws2812,
+	.ws2812_count = ARRAY_SIZE(m_children_ws2812),
+};
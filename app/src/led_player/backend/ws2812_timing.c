@@ -0,0 +1,248 @@
+/*
+ * Copyright (c) 2024 Romain Pelletant
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#include <zephyr/kernel.h>
+#include <string.h>
+
+#include <led_player/backend/ws2812_timing.h>
+
+/////////////////////////////////////
+// Local variables declarations
+/////////////////////////////////////
+
+/**< @brief WS2812 data rate, the driver clocks packed frames from it >*/
+#define WS2812_BIT_RATE		800000U
+
+#define NSEC_PER_SEC_U64	1000000000ULL
+
+/**< @brief Frame widths of the driver, densest first >*/
+static const uint8_t m_frame_bits[] = { 3U, 4U, 8U };
+
+const struct ws2812_timing_spec ws2812_timing_specs[] = {
+	{
+		.name = "ws2812b",
+		.t0h_min = 250U, .t0h_max = 550U, .t0l_min = 700U, .t0l_max = 1000U,
+		.t1h_min = 650U, .t1h_max = 950U, .t1l_min = 300U, .t1l_max = 600U,
+		.reset_min_us = 280U,
+	},
+	{
+		.name = "sk6812",
+		.t0h_min = 150U, .t0h_max = 450U, .t0l_min = 750U, .t0l_max = 1050U,
+		.t1h_min = 450U, .t1h_max = 750U, .t1l_min = 450U, .t1l_max = 750U,
+		.reset_min_us = 80U,
+	},
+};
+
+const size_t ws2812_timing_spec_count = ARRAY_SIZE(ws2812_timing_specs);
+
+/////////////////////////////////////
+// Local function declarations
+/////////////////////////////////////
+
+/**
+ * @brief Distance of a pulse to the closest bound of a symbol
+ *
+ * @return int32_t margin in ns, negative when out of bounds
+ */
+static int32_t symbol_margin(const struct ws2812_pulse *pulse, uint16_t h_min, uint16_t h_max,
+			     uint16_t l_min, uint16_t l_max);
+
+/////////////////////////////////////
+// Local functions definition
+/////////////////////////////////////
+
+static int32_t symbol_margin(const struct ws2812_pulse *pulse, uint16_t h_min, uint16_t h_max,
+			     uint16_t l_min, uint16_t l_max)
+{
+	int32_t margin = (int32_t) pulse->high_ns - h_min;
+
+	margin = MIN(margin, (int32_t) h_max - (int32_t) pulse->high_ns);
+	margin = MIN(margin, (int32_t) pulse->low_ns - l_min);
+	margin = MIN(margin, (int32_t) l_max - (int32_t) pulse->low_ns);
+
+	return margin;
+}
+
+static uint32_t bits_to_ns(uint32_t bits, uint32_t frequency)
+{
+	return (bits * NSEC_PER_SEC_U64) / frequency;
+}
+
+/* Frame of high_bits ones followed by zeros */
+static uint8_t frame_of(uint8_t frame_bits, uint8_t high_bits)
+{
+	return (uint8_t) (BIT_MASK(high_bits) << (frame_bits - high_bits));
+}
+
+/////////////////////////////////////
+// Functions definition
+/////////////////////////////////////
+
+uint32_t ws2812_timing_bus_frequency(uint8_t frame_bits, uint32_t requested, uint32_t src_clock)
+{
+	if (frame_bits != 8U) {
+		requested = WS2812_BIT_RATE * frame_bits;
+	}
+
+	if (src_clock == 0U || requested == 0U) {
+		return requested;
+	}
+
+	return src_clock / DIV_ROUND_UP(src_clock, requested);
+}
+
+void ws2812_timing_encode(const struct ws2812_encoding *enc, const uint8_t *bytes, size_t count,
+			  uint8_t *buf)
+{
+	size_t pos = 0U;
+
+	memset(buf, 0, count * enc->frame_bits);
+
+	for (size_t i = 0; i < count; i++) {
+		for (int bit = 7; bit >= 0; bit--) {
+			const uint8_t frame = (bytes[i] & BIT(bit)) ? enc->one_frame : enc->zero_frame;
+
+			for (int f = enc->frame_bits - 1; f >= 0; f--, pos++) {
+				if (frame & BIT(f)) {
+					buf[pos / 8U] |= BIT(7U - (pos % 8U));
+				}
+			}
+		}
+	}
+}
+
+int ws2812_timing_decode(const uint8_t *buf, size_t len, uint32_t frequency,
+			 struct ws2812_pulse *pulses, size_t max_pulses)
+{
+	uint32_t high = 0U;
+	uint32_t low = 0U;
+	size_t count = 0U;
+
+	if (frequency == 0U) {
+		return -EINVAL;
+	}
+
+	for (size_t pos = 0; pos <= len * 8U; pos++) {
+		const bool end = pos == len * 8U;
+		const bool bit = !end && (buf[pos / 8U] & BIT(7U - (pos % 8U)));
+
+		/* A pulse ends on the next rising edge or with the buffer */
+		if (high && (end || (bit && low))) {
+			if (count == max_pulses) {
+				return -ENOSPC;
+			}
+			pulses[count].high_ns = bits_to_ns(high, frequency);
+			pulses[count].low_ns = bits_to_ns(low, frequency);
+			count++;
+			high = 0U;
+			low = 0U;
+		}
+
+		if (bit) {
+			high++;
+		} else if (high) {
+			low++;
+		}
+	}
+
+	return count;
+}
+
+int ws2812_timing_check(const struct ws2812_timing_spec *spec, const struct ws2812_pulse *pulses,
+			size_t count, uint8_t *bytes)
+{
+	for (size_t i = 0; i < count; i++) {
+		/* The latch follows the last pulse, its low time is open */
+		struct ws2812_pulse pulse = pulses[i];
+		bool one;
+
+		if (pulse.high_ns >= spec->t1h_min && pulse.high_ns <= spec->t1h_max) {
+			one = true;
+			if (i + 1U == count) {
+				pulse.low_ns = spec->t1l_min;
+			}
+			if (symbol_margin(&pulse, spec->t1h_min, spec->t1h_max,
+					  spec->t1l_min, spec->t1l_max) < 0) {
+				return i;
+			}
+		} else {
+			one = false;
+			if (i + 1U == count) {
+				pulse.low_ns = spec->t0l_min;
+			}
+			if (symbol_margin(&pulse, spec->t0h_min, spec->t0h_max,
+					  spec->t0l_min, spec->t0l_max) < 0) {
+				return i;
+			}
+		}
+
+		if (bytes) {
+			if ((i % 8U) == 0U) {
+				bytes[i / 8U] = 0U;
+			}
+			if (one) {
+				bytes[i / 8U] |= BIT(7U - (i % 8U));
+			}
+		}
+	}
+
+	return -1;
+}
+
+int ws2812_timing_tune(const struct ws2812_timing_spec *spec,
+		       const struct ws2812_bus_limits *limits, struct ws2812_encoding *enc)
+{
+	const uint32_t bit_max_ns = MAX(spec->t0h_max + spec->t0l_max,
+					spec->t1h_max + spec->t1l_max);
+
+	for (size_t w = 0; w < ARRAY_SIZE(m_frame_bits); w++) {
+		const uint8_t frame_bits = m_frame_bits[w];
+		uint32_t frequency = ws2812_timing_bus_frequency(frame_bits, limits->max_frequency,
+								 limits->src_clock);
+
+		/* Fastest clock first, 8-bit frames may slow down to fit */
+		while (frequency != 0U && bits_to_ns(frame_bits, frequency) <= bit_max_ns) {
+			int32_t best = -1;
+
+			for (uint8_t one = 1U; one < frame_bits; one++) {
+				for (uint8_t zero = 1U; zero < one; zero++) {
+					const struct ws2812_pulse p1 = {
+						.high_ns = bits_to_ns(one, frequency),
+						.low_ns = bits_to_ns(frame_bits - one, frequency),
+					};
+					const struct ws2812_pulse p0 = {
+						.high_ns = bits_to_ns(zero, frequency),
+						.low_ns = bits_to_ns(frame_bits - zero, frequency),
+					};
+					const int32_t margin = MIN(
+						symbol_margin(&p1, spec->t1h_min, spec->t1h_max,
+							      spec->t1l_min, spec->t1l_max),
+						symbol_margin(&p0, spec->t0h_min, spec->t0h_max,
+							      spec->t0l_min, spec->t0l_max));
+
+					if (margin >= limits->margin_ns && margin > best) {
+						best = margin;
+						enc->frequency = frequency;
+						enc->frame_bits = frame_bits;
+						enc->one_frame = frame_of(frame_bits, one);
+						enc->zero_frame = frame_of(frame_bits, zero);
+					}
+				}
+			}
+
+			if (best >= 0) {
+				return 0;
+			}
+
+			/* Packed frames are clocked by the driver, nothing else to try */
+			if (frame_bits != 8U || limits->src_clock == 0U) {
+				break;
+			}
+			frequency = limits->src_clock / (limits->src_clock / frequency + 1U);
+		}
+	}
+
+	return -ENOENT;
+}
@@ -0,0 +1,132 @@
+/*
+ * Copyright (c) 2024 Romain Pelletant
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#ifndef WS2812_TIMING_H
+#define WS2812_TIMING_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+/*
+ * Model of the WS2812 SPI bitstream: an SPI buffer is decoded back into the
+ * pulses seen on the data line and checked against the chipset timings. It
+ * has no hardware dependency, so it runs as well from a native_sim test as
+ * from the shell.
+ */
+
+/**< @brief Chipset timing tolerances, in ns unless stated >*/
+struct ws2812_timing_spec {
+	const char *name;
+	uint16_t t0h_min;
+	uint16_t t0h_max;
+	uint16_t t0l_min;
+	uint16_t t0l_max;
+	uint16_t t1h_min;
+	uint16_t t1h_max;
+	uint16_t t1l_min;
+	uint16_t t1l_max;
+	/* Line held low this long latches the frame, in us */
+	uint16_t reset_min_us;
+};
+
+/**< @brief One pulse on the data line: high then low >*/
+struct ws2812_pulse {
+	uint32_t high_ns;
+	uint32_t low_ns;
+};
+
+/**< @brief SPI encoding of a WS2812 bit, as set in the devicetree >*/
+struct ws2812_encoding {
+	/* Bus clock actually reached by the controller */
+	uint32_t frequency;
+	/* SPI bits per WS2812 bit: 3 and 4 are packed, 8 is one byte */
+	uint8_t frame_bits;
+	uint8_t one_frame;
+	uint8_t zero_frame;
+};
+
+/**< @brief SPI controller limits the tuner searches within >*/
+struct ws2812_bus_limits {
+	/* Clock source, the bus runs at an integer division of it */
+	uint32_t src_clock;
+	/* spi-max-frequency */
+	uint32_t max_frequency;
+	/* Kept from every tolerance bound, in ns */
+	uint16_t margin_ns;
+};
+
+/**< @brief Datasheet timings of the supported chipsets >*/
+extern const struct ws2812_timing_spec ws2812_timing_specs[];
+extern const size_t ws2812_timing_spec_count;
+
+/**
+ * @brief Get the bus clock of an encoding as the driver sets it
+ * @details Packed frames run at frame_bits times the 800 kHz bit rate, 8-bit
+ *          frames at the requested frequency. The controller then rounds
+ *          down to src_clock / n.
+ *
+ * @param[in] frame_bits: SPI bits per WS2812 bit
+ * @param[in] requested: spi-max-frequency
+ * @param[in] src_clock: controller clock source, 0 if any frequency is reached
+ * @return uint32_t bus clock in Hz
+ */
+uint32_t ws2812_timing_bus_frequency(uint8_t frame_bits, uint32_t requested, uint32_t src_clock);
+
+/**
+ * @brief Encode channel bytes into an SPI buffer
+ * @details Reference encoder: frames MSB first, packed frames cross byte
+ *          boundaries as in the driver buffer.
+ *
+ * @param[in] enc: encoding to use
+ * @param[in] bytes: channel values in wire order
+ * @param[in] count: number of channel values
+ * @param[out] buf: SPI buffer, count * frame_bits bytes
+ */
+void ws2812_timing_encode(const struct ws2812_encoding *enc, const uint8_t *bytes, size_t count,
+			  uint8_t *buf);
+
+/**
+ * @brief Decode an SPI buffer into the pulses of the data line
+ * @details Low bits before the first high bit are idle line and skipped. The
+ *          low time of the last pulse stops at the end of the buffer.
+ *
+ * @param[in] buf: SPI buffer, sent MSB first
+ * @param[in] len: buffer length in bytes
+ * @param[in] frequency: bus clock in Hz
+ * @param[out] pulses: decoded pulses
+ * @param[in] max_pulses: size of pulses
+ * @return int number of pulses, -ENOSPC if they do not fit
+ */
+int ws2812_timing_decode(const uint8_t *buf, size_t len, uint32_t frequency,
+			 struct ws2812_pulse *pulses, size_t max_pulses);
+
+/**
+ * @brief Check pulses against a chipset and read back the bits they carry
+ * @details The low time of the last pulse is the latch and is not checked.
+ *
+ * @param[in] spec: chipset tolerances
+ * @param[in] pulses: decoded pulses
+ * @param[in] count: number of pulses
+ * @param[out] bytes: DIV_ROUND_UP(count, 8) bytes, bits MSB first, may be NULL
+ * @return int index of the first pulse out of spec, -1 if all pass
+ */
+int ws2812_timing_check(const struct ws2812_timing_spec *spec, const struct ws2812_pulse *pulses,
+			size_t count, uint8_t *bytes);
+
+/**
+ * @brief Find the densest encoding that meets a chipset timings
+ * @details Fewest SPI bits per WS2812 bit first, so fewest bytes per pixel,
+ *          then the fastest bus clock, then the pair of frames with the
+ *          most margin. Only frame widths the driver supports are tried.
+ *
+ * @param[in] spec: chipset tolerances
+ * @param[in] limits: SPI controller limits
+ * @param[out] enc: best encoding
+ * @return int 0 on success, -ENOENT if no encoding passes
+ */
+int ws2812_timing_tune(const struct ws2812_timing_spec *spec,
+		       const struct ws2812_bus_limits *limits, struct ws2812_encoding *enc);
+
+#endif /* WS2812_TIMING_H */
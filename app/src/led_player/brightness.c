@@ -0,0 +1,146 @@
+/*
+ * Copyright (c) 2024 Romain Pelletant
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#include <zephyr/kernel.h>
+#include <string.h>
+
+#include <led_player/brightness.h>
+
+/////////////////////////////////////
+// Local variables declarations
+/////////////////////////////////////
+
+/**< @brief Q16 fixed point unit >*/
+#define Q16_ONE		(1UL << 16)
+
+/////////////////////////////////////
+// Local function declarations
+/////////////////////////////////////
+
+/**
+ * @brief Convert a CIE lightness into a linear luminance factor
+ *
+ * @param[in] lightness: lightness L* in percent with BRIGHTNESS_FRAC_SHIFT bits of fraction
+ * @return uint32_t luminance Y in Q16 (0 to Q16_ONE)
+ */
+static uint32_t cie_lightness_to_q16(uint16_t lightness);
+
+/**
+ * @brief Split a brightness between a hardware level and a residual table scale
+ *
+ * @param[in] brightness: brightness in percent, fixed point
+ * @param[in] levels: number of hardware levels above off
+ * @param[out] residual: table scale in Q16, 0 when the level is 0
+ * @return uint8_t hardware level (0 to levels)
+ */
+static uint8_t hw_split(uint16_t brightness, uint8_t levels, uint32_t *residual);
+
+/////////////////////////////////////
+// Local functions definition
+/////////////////////////////////////
+
+static uint32_t cie_lightness_to_q16(uint16_t lightness)
+{
+	uint64_t t;
+
+	if (lightness <= (8U << BRIGHTNESS_FRAC_SHIFT)) {
+		/* Linear toe of the curve: Y = L / 903.3 */
+		return ((uint64_t) lightness * Q16_ONE * 10U) / (9033U << BRIGHTNESS_FRAC_SHIFT);
+	}
+
+	/* Y = ((L + 16) / 116)^3 */
+	t = ((lightness + (16U << BRIGHTNESS_FRAC_SHIFT)) * (uint64_t) Q16_ONE) /
+	    (116U << BRIGHTNESS_FRAC_SHIFT);
+
+	return (uint32_t)((t * t * t) >> 32);
+}
+
+static uint8_t hw_split(uint16_t brightness, uint8_t levels, uint32_t *residual)
+{
+	uint32_t scale;
+	uint8_t level;
+
+	if (brightness > (BRIGHTNESS_MAX << BRIGHTNESS_FRAC_SHIFT)) {
+		brightness = BRIGHTNESS_MAX << BRIGHTNESS_FRAC_SHIFT;
+	}
+
+	scale = cie_lightness_to_q16(brightness);
+	level = DIV_ROUND_UP((uint64_t) scale * levels, Q16_ONE);
+
+	/* scale = level / levels * residual, residual <= 1 */
+	*residual = level ? ((uint64_t) scale * levels) / level : 0U;
+
+	return level;
+}
+
+/////////////////////////////////////
+// Functions definition
+/////////////////////////////////////
+
+void brightness_lut_build(uint8_t *lut, uint8_t brightness)
+{
+	brightness_lut_build_fine(lut, MIN(brightness, BRIGHTNESS_MAX) << BRIGHTNESS_FRAC_SHIFT);
+}
+
+void brightness_lut_build_fine(uint8_t *lut, uint16_t brightness)
+{
+	uint32_t scale;
+
+	if (brightness > (BRIGHTNESS_MAX << BRIGHTNESS_FRAC_SHIFT)) {
+		brightness = BRIGHTNESS_MAX << BRIGHTNESS_FRAC_SHIFT;
+	}
+
+	scale = cie_lightness_to_q16(brightness);
+
+	for (uint32_t i = 0; i < BRIGHTNESS_LUT_SIZE; i++) {
+		lut[i] = (i * scale + (Q16_ONE / 2U)) >> 16;
+	}
+}
+
+uint8_t brightness_lut_build_hw(uint8_t *lut, uint16_t brightness, uint8_t levels)
+{
+	uint32_t residual;
+	const uint8_t level = hw_split(brightness, levels, &residual);
+
+	if (level == 0U) {
+		memset(lut, 0, BRIGHTNESS_LUT_SIZE);
+		return 0U;
+	}
+
+	for (uint32_t i = 0; i < BRIGHTNESS_LUT_SIZE; i++) {
+		lut[i] = (i * residual + (Q16_ONE / 2U)) >> 16;
+	}
+
+	return level;
+}
+
+void brightness_lut16_build_fine(uint16_t *lut, uint16_t brightness)
+{
+	uint32_t scale;
+
+	if (brightness > (BRIGHTNESS_MAX << BRIGHTNESS_FRAC_SHIFT)) {
+		brightness = BRIGHTNESS_MAX << BRIGHTNESS_FRAC_SHIFT;
+	}
+
+	scale = cie_lightness_to_q16(brightness);
+
+	for (uint32_t i = 0; i < BRIGHTNESS_LUT_SIZE; i++) {
+		lut[i] = (i * scale + (1U << (15 - BRIGHTNESS_LUT16_SHIFT))) >>
+			 (16 - BRIGHTNESS_LUT16_SHIFT);
+	}
+}
+
+uint8_t brightness_lut16_build_hw(uint16_t *lut, uint16_t brightness, uint8_t levels)
+{
+	uint32_t residual;
+	const uint8_t level = hw_split(brightness, levels, &residual);
+
+	for (uint32_t i = 0; i < BRIGHTNESS_LUT_SIZE; i++) {
+		lut[i] = (i * residual + (1U << (15 - BRIGHTNESS_LUT16_SHIFT))) >>
+			 (16 - BRIGHTNESS_LUT16_SHIFT);
+	}
+
+	return level;
+}
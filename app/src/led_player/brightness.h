@@ -0,0 +1,81 @@
+/*
+ * Copyright (c) 2024 Romain Pelletant
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef BRIGHTNESS_H
+#define BRIGHTNESS_H
+
+#include <zephyr/kernel.h>
+
+/**< @brief One entry per 8-bit channel value >*/
+#define BRIGHTNESS_LUT_SIZE	256U
+
+/**< @brief Maximal brightness in percent >*/
+#define BRIGHTNESS_MAX		100U
+
+/**< @brief Fractional bits of a fine brightness, used while ramping >*/
+#define BRIGHTNESS_FRAC_SHIFT	8
+
+/**< @brief Fractional bits of a 16-bit table entry: channel value in Q8.8 >*/
+#define BRIGHTNESS_LUT16_SHIFT	8
+
+/**
+ * @brief Build the channel scaling table for a given brightness
+ * @details Brightness is taken as a CIE 1931 lightness so that equal
+ *          steps look equal to the eye. Patterns then scale a channel
+ *          with a single lookup: lut[value].
+ *
+ * @param[out] lut: table of BRIGHTNESS_LUT_SIZE entries to fill
+ * @param[in] brightness: brightness in percent (0-100)
+ */
+void brightness_lut_build(uint8_t *lut, uint8_t brightness);
+
+/**
+ * @brief Build the channel scaling table for a fractional brightness
+ * @details Same as brightness_lut_build() with BRIGHTNESS_FRAC_SHIFT bits of
+ *          fraction, so that a brightness ramp does not move in visible 1%
+ *          steps.
+ *
+ * @param[out] lut: table of BRIGHTNESS_LUT_SIZE entries to fill
+ * @param[in] brightness: brightness in percent, fixed point
+ */
+void brightness_lut_build_fine(uint8_t *lut, uint16_t brightness);
+
+/**
+ * @brief Split a fractional brightness between a hardware dimmer and the table
+ * @details For chipsets with a global brightness register (APA102 has 31
+ *          levels). The smallest hardware level that reaches the brightness
+ *          is picked and the table only scales the rest, so that dim frames
+ *          keep most of their color resolution.
+ *
+ * @param[out] lut: table of BRIGHTNESS_LUT_SIZE entries to fill
+ * @param[in] brightness: brightness in percent, fixed point
+ * @param[in] levels: number of hardware levels above off
+ * @return uint8_t hardware level to apply (0 to levels)
+ */
+uint8_t brightness_lut_build_hw(uint8_t *lut, uint16_t brightness, uint8_t levels);
+
+/**
+ * @brief Build the 16-bit channel scaling table for a fractional brightness
+ * @details Same scaling as brightness_lut_build_fine(), with entries in Q8.8
+ *          instead of rounded to 8 bits: dim channels keep the fraction that
+ *          dithering turns into perceived levels.
+ *
+ * @param[out] lut: table of BRIGHTNESS_LUT_SIZE entries to fill
+ * @param[in] brightness: brightness in percent, fixed point
+ */
+void brightness_lut16_build_fine(uint16_t *lut, uint16_t brightness);
+
+/**
+ * @brief 16-bit version of brightness_lut_build_hw()
+ *
+ * @param[out] lut: table of BRIGHTNESS_LUT_SIZE entries to fill, in Q8.8
+ * @param[in] brightness: brightness in percent, fixed point
+ * @param[in] levels: number of hardware levels above off
+ * @return uint8_t hardware level to apply (0 to levels)
+ */
+uint8_t brightness_lut16_build_hw(uint16_t *lut, uint16_t brightness, uint8_t levels);
+
+#endif /* BRIGHTNESS_H */
@@ -0,0 +1,85 @@
+/*
+ * Copyright (c) 2024 Romain Pelletant
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#include <zephyr/kernel.h>
+
+#include <led_player/dither.h>
+#include <led_player/brightness.h>
+#include <led_player/frame_arena.h>
+
+/////////////////////////////////////
+// Local variables declarations
+/////////////////////////////////////
+
+#define DITHER_CHANNELS		3U
+
+/**< @brief Residual seed step between pixels, 256 / golden ratio: neighbours get
+ * phases far apart and no two close pixels share one >*/
+#define DITHER_SEED_STEP	158U
+
+/////////////////////////////////////
+// Local function declarations
+/////////////////////////////////////
+
+/////////////////////////////////////
+// Local functions definition
+/////////////////////////////////////
+
+static inline uint8_t dither_channel(uint16_t value, uint8_t *residual)
+{
+	/* Q8.8 channels are at most 255 << 8, adding a residual cannot overflow */
+	const uint16_t sum = value + *residual;
+
+	*residual = sum & BIT_MASK(BRIGHTNESS_LUT16_SHIFT);
+
+	return sum >> BRIGHTNESS_LUT16_SHIFT;
+}
+
+/////////////////////////////////////
+// Functions definition
+/////////////////////////////////////
+
+int dither_resize(struct dither *dither, size_t length)
+{
+	uint8_t *residual = frame_arena_realloc(dither->residual, length * DITHER_CHANNELS);
+
+	if (!residual) {
+		frame_arena_free(dither->residual);
+		dither->residual = NULL;
+		dither->length = 0U;
+		return -ENOMEM;
+	}
+
+	/* Channels of a pixel share their phase: they step together and the hue holds */
+	for (size_t i = 0; i < length; i++) {
+		const uint8_t seed = i * DITHER_SEED_STEP;
+
+		residual[i * DITHER_CHANNELS] = seed;
+		residual[i * DITHER_CHANNELS + 1U] = seed;
+		residual[i * DITHER_CHANNELS + 2U] = seed;
+	}
+
+	dither->residual = residual;
+	dither->length = length;
+
+	return 0;
+}
+
+bool dither_span(struct dither *dither, struct led_rgb *pixels, const struct pattern_rgb16 *span,
+		 size_t start, size_t count)
+{
+	uint8_t *residual = &dither->residual[start * DITHER_CHANNELS];
+	uint16_t fraction = 0U;
+
+	for (size_t i = 0; i < count; i++) {
+		pixels[i].r = dither_channel(span[i].r, &residual[0]);
+		pixels[i].g = dither_channel(span[i].g, &residual[1]);
+		pixels[i].b = dither_channel(span[i].b, &residual[2]);
+		fraction |= span[i].r | span[i].g | span[i].b;
+		residual += DITHER_CHANNELS;
+	}
+
+	return (fraction & BIT_MASK(BRIGHTNESS_LUT16_SHIFT)) != 0U;
+}
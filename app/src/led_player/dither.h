@@ -0,0 +1,51 @@
+/*
+ * Copyright (c) 2024 Romain Pelletant
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef DITHER_H
+#define DITHER_H
+
+#include <zephyr/kernel.h>
+#include <zephyr/drivers/led_strip.h>
+#include <led_player/pattern/generic.h>
+
+/**< @brief Temporal error diffusion state of a strip >*/
+struct dither {
+	/* Fraction not shown yet of each channel of each pixel, 3 bytes per pixel */
+	uint8_t *residual;
+	size_t length;
+};
+
+/**
+ * @brief Size the dithering state to a strip length
+ * @details The state is taken from the frame arena and seeded with a
+ *          different phase for each pixel, so that pixels of a uniform
+ *          color do not all step up on the same frame.
+ *
+ * @param[inout] dither: dithering state
+ * @param[in] length: number of pixels
+ * @return int 0 on success, -ENOMEM if the arena is full, dithering is then off
+ */
+int dither_resize(struct dither *dither, size_t length);
+
+/**
+ * @brief Quantize a 16-bit span to 8 bits, carrying the fraction to the next frame
+ * @details Each channel shows floor(value + residual) and keeps the rest as
+ *          its residual, so over frames a pixel averages its Q8.8 value.
+ *          Channels without a fraction keep their residual and show the
+ *          same level every frame: the span is settled.
+ *
+ * @param[inout] dither: dithering state
+ * @param[out] pixels: count 8-bit pixels
+ * @param[in] span: count 16-bit pixels, Q8.8
+ * @param[in] start: strip position of the span
+ * @param[in] count: number of pixels, start + count <= length
+ * @return bool true if a channel has a fraction and the span shows other levels on
+ *         the next frames, false if it is settled
+ */
+bool dither_span(struct dither *dither, struct led_rgb *pixels, const struct pattern_rgb16 *span,
+		 size_t start, size_t count);
+
+#endif /* DITHER_H */
@@ -0,0 +1,65 @@
+/*
+ * Copyright (c) 2024 Romain Pelletant
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#include <zephyr/kernel.h>
+#include <zephyr/sys/sys_heap.h>
+
+#include <led_player/frame_arena.h>
+
+/////////////////////////////////////
+// Local variables declarations
+/////////////////////////////////////
+
+K_HEAP_DEFINE(led_frame_heap, CONFIG_APP_FRAME_ARENA_SIZE);
+
+/////////////////////////////////////
+// Local function declarations
+/////////////////////////////////////
+
+/////////////////////////////////////
+// Local functions definition
+/////////////////////////////////////
+
+/////////////////////////////////////
+// Functions definition
+/////////////////////////////////////
+
+void *frame_arena_alloc(size_t size)
+{
+	return k_heap_alloc(&led_frame_heap, size, K_NO_WAIT);
+}
+
+void *frame_arena_realloc(void *ptr, size_t size)
+{
+	return k_heap_realloc(&led_frame_heap, ptr, size, K_NO_WAIT);
+}
+
+void frame_arena_free(void *ptr)
+{
+	k_heap_free(&led_frame_heap, ptr);
+}
+
+int frame_arena_get_stats(struct frame_arena_stats *stats)
+{
+#if defined(CONFIG_SYS_HEAP_RUNTIME_STATS)
+	struct sys_memory_stats heap_stats;
+	int err;
+
+	err = sys_heap_runtime_stats_get(&led_frame_heap.heap, &heap_stats);
+	if (err) {
+		return err;
+	}
+
+	stats->size = CONFIG_APP_FRAME_ARENA_SIZE;
+	stats->used = heap_stats.allocated_bytes;
+	stats->peak = heap_stats.max_allocated_bytes;
+
+	return 0;
+#else
+	ARG_UNUSED(stats);
+
+	return -ENOTSUP;
+#endif
+}
@@ -0,0 +1,65 @@
+/*
+ * Copyright (c) 2024 Romain Pelletant
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef FRAME_ARENA_H
+#define FRAME_ARENA_H
+
+#include <zephyr/kernel.h>
+
+/*
+ * Dedicated heap of every buffer sized by the strip length: strip driver
+ * frames, whole frames of strips without span encoding and pattern caches.
+ * They are resized together with the strip, away from the system heap used
+ * by the Bluetooth stack. The WS2812 SPI driver allocates from it with
+ * CONFIG_WS2812_STRIP_SPI_FRAME_HEAP.
+ */
+
+/**< @brief Arena usage in bytes >*/
+struct frame_arena_stats {
+	size_t size;
+	size_t used;
+	/* Most bytes used at once since boot */
+	size_t peak;
+};
+
+/**< @brief The arena, named for the strip driver >*/
+extern struct k_heap led_frame_heap;
+
+/**
+ * @brief Allocate from the arena, never waits
+ *
+ * @param[in] size: bytes to allocate
+ * @return void * NULL when the arena is full
+ */
+void *frame_arena_alloc(size_t size);
+
+/**
+ * @brief Resize an arena allocation, never waits
+ * @details Same as realloc(): ptr may be NULL and is left untouched when
+ *          NULL is returned.
+ *
+ * @param[in] ptr: allocation to resize
+ * @param[in] size: new size in bytes
+ * @return void * NULL when the arena is full
+ */
+void *frame_arena_realloc(void *ptr, size_t size);
+
+/**
+ * @brief Release an arena allocation
+ *
+ * @param[in] ptr: allocation, may be NULL
+ */
+void frame_arena_free(void *ptr);
+
+/**
+ * @brief Get the arena usage and high-water mark
+ *
+ * @param[out] stats: usage
+ * @return int 0 on success, -ENOTSUP without CONFIG_SYS_HEAP_RUNTIME_STATS
+ */
+int frame_arena_get_stats(struct frame_arena_stats *stats);
+
+#endif /* FRAME_ARENA_H */
@@ -8,9 +8,17 @@
 
 #include <factory_settings/factory_settings.h>
 #include <context_storage/context_storage.h>
+#include <led_player/led_player.h>
 #include <zephyr/drivers/led_strip.h>
 
 #include <led_player/pattern/generic.h>
+#include <led_player/brightness.h>
+#include <led_player/transition.h>
+#include <led_player/ramp.h>
+#include <led_player/frame_arena.h>
+#include <led_player/dither.h>
+#include <led_player/backend/backend.h>
+#include <led_player/backend/ws2812_timing.h>
 
 #include <zephyr/logging/log.h>
 LOG_MODULE_REGISTER(led_player, CONFIG_APP_LOG_LEVEL);
@@ -28,12 +36,49 @@ K_MUTEX_DEFINE(m_generic_mutex);
 /**< @brief Generic interface status to schedule FSM >*/
 atomic_t m_mode = ATOMIC_INIT(0);
 atomic_t m_color = ATOMIC_INIT(0);
-atomic_t m_speed = ATOMIC_INIT(0);
+atomic_t m_speed = ATOMIC_INIT(CONFIG_APP_LED_PLAYER_SPEED);
 atomic_t m_brightness = ATOMIC_INIT(100);
 
+/**< @brief Bus result of the last frame latched by the strip >*/
+static atomic_t m_frame_result = ATOMIC_INIT(0);
+
+/**< @brief Frame scheduler: period timer and counters >*/
+K_TIMER_DEFINE(m_frame_timer, NULL, NULL);
+static atomic_t m_fps = ATOMIC_INIT(CONFIG_APP_LED_PLAYER_FPS);
+static atomic_t m_frames = ATOMIC_INIT(0);
+static atomic_t m_missed_deadlines = ATOMIC_INIT(0);
+
+/**< @brief Bumped on every input change, static frames are only rendered once >*/
+static atomic_t m_generation = ATOMIC_INIT(0);
+static atomic_t m_skipped_frames = ATOMIC_INIT(0);
+static atomic_t m_rotated_frames = ATOMIC_INIT(0);
+static atomic_t m_prefix_frames = ATOMIC_INIT(0);
+static atomic_t m_render_us = ATOMIC_INIT(0);
+static atomic_t m_render_us_max = ATOMIC_INIT(0);
+
 static struct context_data m_context_data;
 
-#define STRIP_NODE		DT_ALIAS(led_strip)
+/**< @brief Channel scaling table for the current brightness >*/
+static uint8_t m_brightness_lut[BRIGHTNESS_LUT_SIZE];
+
+/**< @brief Same table in Q8.8, and whether it is worth dithering: the 8-bit table
+ * collapses levels and drops fractions the 16-bit one keeps >*/
+static uint16_t m_brightness_lut16[BRIGHTNESS_LUT_SIZE];
+static bool m_lut16_dither;
+
+/**< @brief Temporal dithering, residual is NULL when it is off >*/
+static struct dither m_dither;
+/**< @brief Frame is rendered at 16 bits then dithered >*/
+static bool m_dithered;
+/**< @brief Last dithered frame had fractions to show: the next one differs >*/
+static bool m_dither_moving;
+
+/**< @brief Displayed brightness and color: setters move targets, the loop ramps.
+ * Protected by m_generic_mutex, brightness is fine (BRIGHTNESS_FRAC_SHIFT) >*/
+static struct ramp m_brightness_ramp;
+static struct ramp m_color_ramp;
+static atomic_t m_ramp_ms = ATOMIC_INIT(CONFIG_APP_LED_PLAYER_RAMP_MS);
+static atomic_t m_ramp_easing = ATOMIC_INIT(RAMP_EASING_EASE_IN_OUT);
 
 // #if DT_NODE_HAS_PROP(DT_ALIAS(led_strip), chain_length)
 // #define STRIP_NUM_PIXELS	DT_PROP(DT_ALIAS(led_strip), chain_length)
@@ -42,7 +87,10 @@ static struct context_data m_context_data;
 // #endif
 #define STRIP_NUM_PIXELS	14
 
-#define DELAY_TIME K_MSEC(50)
+#define LED_PLAYER_FPS_MAX	100U
+
+/**< @brief Longest time step given to patterns, a stalled loop must not make them jump >*/
+#define LED_PLAYER_DELTA_MAX	FRAME_TIME_ONE
 
 #define RGB(_r, _g, _b) { .r = (_r), .g = (_g), .b = (_b) }
 
@@ -53,11 +101,42 @@ static struct context_data m_context_data;
 // };
 
 // static struct led_rgb pixels[STRIP_NUM_PIXELS];
+/**< @brief Whole frame, only allocated when the strip cannot encode spans >*/
 struct led_rgb *pixel_array = NULL;
 
+/**< @brief Span rendered then encoded straight into the strip frame buffer, in the
+ * format of the pattern when the strip expands compact pixels >*/
+static union {
+	struct led_rgb rgb[CONFIG_APP_LED_PLAYER_TILE_PIXELS];
+	uint16_t rgb565[CONFIG_APP_LED_PLAYER_TILE_PIXELS];
+	uint8_t index8[CONFIG_APP_LED_PLAYER_TILE_PIXELS];
+} m_span;
+static bool m_formats_supported;
+
+/**< @brief 16-bit tile of a dithered frame >*/
+static struct pattern_rgb16 m_span16[CONFIG_APP_LED_PLAYER_TILE_PIXELS];
+
+/**< @brief Runs of uniform patterns, encoded once per run by the strip >*/
+static struct led_strip_run m_runs[PATTERN_RUNS_MAX];
+static bool m_runs_supported;
+
+/**< @brief Strip can resend its last frame rotated, see pattern rotation >*/
+static bool m_rotate_supported;
+
+/**< @brief Strip can send only the head of a frame, see pattern dirty >*/
+static bool m_prefix_supported;
+
 static size_t led_numbers;
 
-static const struct device *const strip = DEVICE_DT_GET(STRIP_NODE);
+/**< @brief Length set by led_player_set_length(), applied by the loop between two frames >*/
+static atomic_t m_resize_length = ATOMIC_INIT(0);
+static int m_resize_result;
+static K_SEM_DEFINE(m_resize_done, 0, 1);
+static K_MUTEX_DEFINE(m_resize_mutex);
+
+/**< @brief Chipset backend picked from the factory settings at init >*/
+static const struct led_backend *m_backend;
+static const struct device *strip;
 
 #define ACQ_STACK_SIZE                1024
 #define ACQ_THREAD_PRIORITY           8
@@ -66,7 +145,12 @@ k_tid_t thread_id;
 struct k_thread thread_data;
 K_THREAD_STACK_DEFINE(m_thread_stack, ACQ_STACK_SIZE);
 
-static struct pattern_interface m_pattern_interface;
+/**< @brief Selected pattern, NULL until the first led_player_set_mode() >*/
+static const struct pattern_descriptor *m_pattern;
+
+/**< @brief Fade from the previous pattern, protected by m_generic_mutex >*/
+static struct transition m_transition;
+static atomic_t m_transition_ms = ATOMIC_INIT(CONFIG_APP_LED_PLAYER_TRANSITION_MS);
 
 struct k_work_delayable work;
 
@@ -74,10 +158,23 @@ struct k_work_delayable work;
 // Local function declarations
 /////////////////////////////////////
 
+/**
+ * @brief Apply a LED number set in the factory settings
+ *
+ * @param[in] led_length: new LED number
+ * @return int 0 if resized now, negative if applied at next boot
+ */
+static int apply_factory_length(uint32_t led_length);
+
 /////////////////////////////////////
 // Local functions definition
 /////////////////////////////////////
 
+static int apply_factory_length(uint32_t led_length)
+{
+	return led_player_set_length(led_length);
+}
+
 static void save_context(struct k_work *item)
 {
     // struct device_info *the_device =
@@ -86,26 +183,384 @@ static void save_context(struct k_work *item)
 	LOG_INF("SAVE CONTEXT");
 }
 
+static void start_frame_timer(uint32_t fps)
+{
+	/* Periodic timer: deadlines are absolute, render time does not add up */
+	k_timer_start(&m_frame_timer, K_NO_WAIT, K_USEC(USEC_PER_SEC / fps));
+}
+
+static inline void mark_dirty(void)
+{
+	atomic_inc(&m_generation);
+}
+
+/**< @brief Time since start in seconds Q16.16, derived from the absolute uptime so it does not drift >*/
+static uint32_t frame_time_now(int64_t start)
+{
+	uint64_t elapsed_us = k_ticks_to_us_floor64(k_uptime_ticks() - start);
+
+	return (uint32_t) ((elapsed_us << FRAME_TIME_SHIFT) / USEC_PER_SEC);
+}
+
+static void set_brightness_target(uint8_t brightness)
+{
+	ramp_set_target(&m_brightness_ramp, brightness << BRIGHTNESS_FRAC_SHIFT,
+			atomic_get(&m_ramp_ms), atomic_get(&m_ramp_easing));
+}
+
+static void set_color_target(uint32_t color)
+{
+	ramp_set_target(&m_color_ramp, color, atomic_get(&m_ramp_ms), atomic_get(&m_ramp_easing));
+}
+
+static void frame_done(const struct device *dev, int result, void *user_data)
+{
+	ARG_UNUSED(dev);
+	ARG_UNUSED(user_data);
+
+	atomic_set(&m_frame_result, result);
+}
+
+/**< @brief Dim enough for the 8-bit table to collapse levels, with fractions to show >*/
+static bool lut16_worth_dithering(const uint8_t *lut, const uint16_t *lut16)
+{
+	if (lut[BRIGHTNESS_LUT_SIZE - 1U] >= CONFIG_APP_LED_PLAYER_DITHER_LEVELS) {
+		return false;
+	}
+
+	for (size_t i = 0; i < BRIGHTNESS_LUT_SIZE; i++) {
+		if (lut16[i] & BIT_MASK(BRIGHTNESS_LUT16_SHIFT)) {
+			return true;
+		}
+	}
+
+	return false;
+}
+
+/**< @brief Render the brightness tables, the 16-bit one only when dithering is on >*/
+static void build_brightness_luts(uint16_t brightness)
+{
+	const bool wide = m_dither.residual != NULL;
+
+	if (m_backend->set_brightness) {
+		/* Coarse dimming in the LEDs, the table scales the rest */
+		uint8_t level = brightness_lut_build_hw(m_brightness_lut, brightness,
+							m_backend->brightness_levels);
+
+		if (wide) {
+			brightness_lut16_build_hw(m_brightness_lut16, brightness,
+						  m_backend->brightness_levels);
+		}
+		m_backend->set_brightness(strip, level);
+	} else {
+		brightness_lut_build_fine(m_brightness_lut, brightness);
+		if (wide) {
+			brightness_lut16_build_fine(m_brightness_lut16, brightness);
+		}
+	}
+
+	m_lut16_dither = wide && lut16_worth_dithering(m_brightness_lut, m_brightness_lut16);
+}
+
+/**< @brief Render a span at 16 bits tile by tile, and dither it down to 8 bits >*/
+static void render_span_dithered(struct frame_context *ctx, struct led_rgb *pixels)
+{
+	struct frame_context tile_ctx = *ctx;
+
+	for (size_t done = 0U; done < ctx->count; done += ARRAY_SIZE(m_span16)) {
+		tile_ctx.start = ctx->start + done;
+		tile_ctx.count = MIN(ARRAY_SIZE(m_span16), ctx->count - done);
+		transition_render_span16(&m_transition, m_pattern, m_span16, &tile_ctx);
+		m_dither_moving |= dither_span(&m_dither, &pixels[done], m_span16, tile_ctx.start,
+						tile_ctx.count);
+	}
+}
+
+/**< @brief Same as render_spans() for patterns keeping a compact format >*/
+static int render_spans_compact(struct frame_context *ctx, size_t count)
+{
+	const struct led_rgb *palette = NULL;
+	int err;
+
+	if (m_pattern->process_index8) {
+		palette = m_pattern->palette(ctx);
+	}
+
+	for (size_t start = 0U; start < count; start += CONFIG_APP_LED_PLAYER_TILE_PIXELS) {
+		ctx->start = start;
+		ctx->count = MIN(CONFIG_APP_LED_PLAYER_TILE_PIXELS, count - start);
+
+		if (palette) {
+			m_pattern->process_index8(m_span.index8, ctx);
+			err = led_strip_encode_span_format(strip, start, LED_STRIP_FORMAT_INDEX8,
+							   m_span.index8, ctx->count, palette);
+		} else {
+			m_pattern->process_rgb565(m_span.rgb565, ctx);
+			err = led_strip_encode_span_format(strip, start, LED_STRIP_FORMAT_RGB565,
+							   m_span.rgb565, ctx->count, NULL);
+		}
+		if (err) {
+			return err;
+		}
+	}
+
+	return 0;
+}
+
+/**< @brief Render the first count pixels span by span into the strip frame buffer >*/
+static int render_spans(struct frame_context *ctx, size_t count)
+{
+	int err;
+
+	/* Dithered pixels differ from their neighbours, no run nor compact format */
+	if (m_dithered) {
+		for (size_t start = 0U; start < count; start += ARRAY_SIZE(m_span.rgb)) {
+			ctx->start = start;
+			ctx->count = MIN(ARRAY_SIZE(m_span.rgb), count - start);
+			render_span_dithered(ctx, m_span.rgb);
+
+			err = led_strip_encode_span(strip, start, m_span.rgb, ctx->count);
+			if (err) {
+				return err;
+			}
+		}
+
+		return 0;
+	}
+
+	if (m_runs_supported && m_pattern->runs && !transition_active(&m_transition)) {
+		ctx->start = 0U;
+		ctx->count = count;
+
+		return led_strip_encode_runs(strip, 0U, m_runs,
+					     m_pattern->runs(m_runs, ARRAY_SIZE(m_runs), ctx));
+	}
+
+	/* Transitions blend in RGB */
+	if (m_formats_supported && (m_pattern->process_index8 || m_pattern->process_rgb565) &&
+	    !transition_active(&m_transition)) {
+		return render_spans_compact(ctx, count);
+	}
+
+	for (size_t start = 0U; start < count; start += ARRAY_SIZE(m_span.rgb)) {
+		ctx->start = start;
+		ctx->count = MIN(ARRAY_SIZE(m_span.rgb), count - start);
+		transition_render_span(&m_transition, m_pattern, m_span.rgb, ctx);
+
+		err = led_strip_encode_span(strip, start, m_span.rgb, ctx->count);
+		if (err) {
+			return err;
+		}
+	}
+
+	return 0;
+}
+
+/**< @brief Render the whole frame into pixel_array, for strips without span encoding >*/
+static void render_frame(struct frame_context *ctx)
+{
+	ctx->start = 0U;
+	ctx->count = ctx->led_numbers;
+	if (m_dithered) {
+		render_span_dithered(ctx, pixel_array);
+	} else {
+		transition_render_span(&m_transition, m_pattern, pixel_array, ctx);
+	}
+}
+
+/**< @brief Resize the strip and the whole frame, called by the loop: the previous frame
+ * was handed to the strip, which waits for it to leave the wire >*/
+static int apply_length(size_t length)
+{
+	struct led_rgb *frame;
+	int err;
+
+	/* A strip, or a group, that fails keeps its previous length */
+	err = led_strip_set_length(strip, length);
+	if (err) {
+		return err;
+	}
+
+	if (pixel_array) {
+		frame = frame_arena_realloc(pixel_array, sizeof(struct led_rgb) * length);
+		if (!frame) {
+			err = led_strip_set_length(strip, led_numbers);
+			if (err) {
+				LOG_ERR("Strip length %zu not restored (%d)", led_numbers, err);
+			}
+			return -ENOMEM;
+		}
+		pixel_array = frame;
+	}
+
+	/* Dithering is optional, the new length is kept without it */
+	if (IS_ENABLED(CONFIG_APP_LED_PLAYER_DITHER) && dither_resize(&m_dither, length)) {
+		LOG_WRN("No room for the dithering state, dithering is off");
+	}
+
+	led_numbers = length;
+
+	return 0;
+}
+
 static void led_player_loop(void *arg1, void *arg2, void *arg3)
 {
 	int err;
-	uint32_t current_color = 0U;
-	uint8_t scaled_brightness = 0U;
+	uint32_t lut_brightness = UINT32_MAX;
+	uint32_t expired;
+	bool ramping;
+	atomic_val_t generation;
+	atomic_val_t rendered_generation = 0;
+	bool frame_valid = false;
+	bool unchanged;
+	/* Last rendered frame can be rotated, it was rendered at base_rotation */
+	bool base_valid = false;
+	size_t base_rotation = 0U;
+	size_t dirty;
+	uint32_t begin;
+	uint32_t render_us;
+	const int64_t start = k_uptime_ticks();
+	struct frame_context ctx = { 0 };
+	uint32_t now;
+	size_t length;
 
 	ARG_UNUSED(arg1);
 	ARG_UNUSED(arg2);
 	ARG_UNUSED(arg3);
 
+	start_frame_timer(atomic_get(&m_fps));
+
 	while(1) {
-		current_color = atomic_get(&m_color);
-		scaled_brightness = 1 + ((100 - atomic_get(&m_brightness)) * 23 / 100);
-		m_pattern_interface.pattern_process(pixel_array, scaled_brightness, led_numbers, current_color);
+		expired = k_timer_status_sync(&m_frame_timer);
+		if (expired > 1U) {
+			atomic_add(&m_missed_deadlines, expired - 1U);
+			LOG_DBG("missed %u frame deadline(s)", expired - 1U);
+		}
+		atomic_inc(&m_frames);
+
+		length = atomic_clear(&m_resize_length);
+		if (length) {
+			m_resize_result = apply_length(length);
+			k_sem_give(&m_resize_done);
+			frame_valid = false;
+			base_valid = false;
+			/* Dithering may have been turned on or off */
+			lut_brightness = UINT32_MAX;
+		}
 
-		err = led_strip_update_rgb(strip, pixel_array, led_numbers);
+		/* Checked before the skips: a frame that failed on the bus is sent again */
+		err = atomic_clear(&m_frame_result);
+		if (err) {
+			LOG_ERR("previous frame failed on bus: %d", err);
+			frame_valid = false;
+		}
+
+		/* Pattern cannot be released while it renders */
+		k_mutex_lock(&m_generic_mutex, K_FOREVER);
+
+		/* Read before the inputs so that a concurrent change is never lost */
+		generation = atomic_get(&m_generation);
+
+		now = frame_time_now(start);
+		ctx.delta = MIN(now - ctx.time, LED_PLAYER_DELTA_MAX);
+		ctx.time = now;
+
+		ramping = ramp_step(&m_brightness_ramp, ctx.delta);
+		ramping |= ramp_step(&m_color_ramp, ctx.delta);
+
+		unchanged = !ramping && frame_valid && generation == rendered_generation;
+
+		/* A dithered frame moves even when its inputs do not, until it settles */
+		if (m_pattern->is_static && !transition_active(&m_transition) && unchanged &&
+		    !(m_dithered && m_dither_moving)) {
+			k_mutex_unlock(&m_generic_mutex);
+			atomic_inc(&m_skipped_frames);
+			continue;
+		}
+		rendered_generation = generation;
+		frame_valid = true;
+
+		if (m_brightness_ramp.value != lut_brightness) {
+			build_brightness_luts(m_brightness_ramp.value);
+			lut_brightness = m_brightness_ramp.value;
+		}
+
+		ctx.speed = atomic_get(&m_speed);
+		ctx.color = m_color_ramp.value;
+		ctx.brightness = m_brightness_lut;
+		ctx.brightness16 = m_brightness_lut16;
+		ctx.led_numbers = led_numbers;
+		transition_advance(&m_transition, m_pattern, &ctx);
+
+		/* Only worth it when the 8-bit table collapses levels */
+		m_dithered = m_lut16_dither && transition_has_process16(&m_transition, m_pattern);
+		m_dither_moving = false;
+
+		/* Pixels past the changed head keep their color on the strip */
+		dirty = led_numbers;
+		if (unchanged && !transition_active(&m_transition) && !m_dithered &&
+		    m_pattern->dirty) {
+			dirty = MIN(m_pattern->dirty(&ctx), led_numbers);
+		}
+		if (dirty == 0U) {
+			k_mutex_unlock(&m_generic_mutex);
+			atomic_inc(&m_skipped_frames);
+			continue;
+		}
+		if (!m_prefix_supported) {
+			dirty = led_numbers;
+		}
+
+		begin = k_cycle_get_32();
+		if (unchanged && base_valid && !transition_active(&m_transition) && !m_dithered) {
+			/* Only the rotation moved: no pixel to render nor encode */
+			const size_t rotation = (base_rotation + led_numbers - m_pattern->rotation()) %
+						led_numbers;
+
+			render_us = k_cyc_to_us_floor32(k_cycle_get_32() - begin);
+			k_mutex_unlock(&m_generic_mutex);
+
+			err = led_strip_rotate_async(strip, rotation, frame_done, NULL);
+			atomic_inc(&m_rotated_frames);
+		} else {
+			base_valid = m_rotate_supported && m_pattern->rotation &&
+				     !transition_active(&m_transition) && !m_dithered &&
+				     dirty == led_numbers;
+			if (base_valid) {
+				base_rotation = m_pattern->rotation();
+			}
+
+			if (pixel_array) {
+				render_frame(&ctx);
+				err = 0;
+			} else {
+				err = render_spans(&ctx, dirty);
+			}
+			render_us = k_cyc_to_us_floor32(k_cycle_get_32() - begin);
+			k_mutex_unlock(&m_generic_mutex);
+
+			if (pixel_array) {
+				/* Frame is encoded on return: next one renders while this one is sent */
+				err = led_strip_update_rgb_async(strip, pixel_array, led_numbers,
+								 frame_done, NULL);
+				if (err == -ENOSYS) {
+					err = led_strip_update_rgb(strip, pixel_array, led_numbers);
+				}
+			} else if (!err && dirty < led_numbers) {
+				err = led_strip_flush_prefix_async(strip, dirty, frame_done, NULL);
+				atomic_inc(&m_prefix_frames);
+			} else if (!err) {
+				err = led_strip_flush_async(strip, frame_done, NULL);
+			}
+		}
+		if (render_us > atomic_get(&m_render_us_max)) {
+			atomic_set(&m_render_us_max, render_us);
+		}
+		atomic_set(&m_render_us, render_us);
 		if (err) {
 			LOG_ERR("couldn't update strip: %d", err);
+			frame_valid = false;
 		}
-		k_sleep(DELAY_TIME);
 	}
 }
 
@@ -119,6 +574,10 @@ int led_player_init(uint32_t *led_length)
 		return -EFAULT;
 	}
 
+	m_backend = led_backend_select(factory_settings_get()->chipset,
+				       factory_settings_get()->rgbw);
+	strip = m_backend->dev;
+
 	if (device_is_ready(strip)) {
 		LOG_INF("Found LED strip device %s", strip->name);
 	} else {
@@ -132,20 +591,41 @@ int led_player_init(uint32_t *led_length)
 	LOG_INF("Displaying pattern on strip");
 	led_strip_set_length(strip, led_numbers);
 
-	pixel_array = (struct led_rgb *) malloc(sizeof(struct led_rgb) * led_numbers);
-	if (!pixel_array) {
-		LOG_ERR("Failed to dynamically alloc LED array");
-		return -EFAULT;
+	/* Spans go straight to the strip buffer, a whole frame is only needed without it */
+	if (led_strip_encode_span(strip, 0U, m_span.rgb, 0U) == -ENOSYS) {
+		pixel_array = frame_arena_alloc(sizeof(struct led_rgb) * led_numbers);
+		if (!pixel_array) {
+			LOG_ERR("Failed to dynamically alloc LED array");
+			return -EFAULT;
+		}
+	}
+
+	if (IS_ENABLED(CONFIG_APP_LED_PLAYER_DITHER) && dither_resize(&m_dither, led_numbers)) {
+		LOG_WRN("No room for the dithering state, dithering is off");
 	}
 
+	m_runs_supported = led_strip_encode_runs(strip, 0U, m_runs, 0U) != -ENOSYS;
+	m_formats_supported = led_strip_encode_span_format(strip, 0U, LED_STRIP_FORMAT_RGB,
+							   m_span.rgb, 0U, NULL) != -ENOSYS;
+
+	/* An empty prefix is rejected with -ERANGE, nothing is sent */
+	m_prefix_supported = !pixel_array &&
+			     led_strip_flush_prefix_async(strip, 0U, NULL, NULL) != -ENOSYS;
+
+	/* No frame was sent yet: -ENODATA when rotation is supported */
+	m_rotate_supported = led_strip_rotate_async(strip, 0U, NULL, NULL) != -ENOSYS;
+
 	if (context_storage_read(&m_context_data)) {
 		m_context_data.brightness = 70U;
 		m_context_data.mode = 0;
-		for(int i = 0; i < LED_PLAYER_MODE_MAX; i++) {
+		for(int i = 0; i < CONTEXT_PATTERN_CONTEXT_MAX_SIZE; i++) {
 			m_context_data.pattern_context[i] = 0U;
 		}
 	}
 
+	ramp_init(&m_brightness_ramp, ramp_lerp_scalar, 0U);
+	ramp_init(&m_color_ramp, ramp_lerp_rgb, 0U);
+
 	led_player_set_mode(m_context_data.mode);
 	led_player_set_brightness(m_context_data.brightness);
 	led_player_set_color(9U);
@@ -157,62 +637,64 @@ int led_player_init(uint32_t *led_length)
 		K_THREAD_STACK_SIZEOF(m_thread_stack), led_player_loop, NULL,
 		NULL, NULL, ACQ_THREAD_PRIORITY, K_ESSENTIAL, K_NO_WAIT);
 
+	factory_settings_set_led_length_cb(apply_factory_length);
+
 	return 0;
 }
 
-void led_player_set_mode(enum led_player_mode mode)
+void led_player_set_mode(uint32_t mode)
 {
-	enum led_player_mode previous_mode;
+	uint32_t previous_mode;
+	const struct pattern_descriptor *pattern;
 	k_mutex_lock(&m_generic_mutex, K_FOREVER);
-	if (mode >= LED_PLAYER_MODE_UNISHINE) {
-		mode = LED_PLAYER_MODE_UNICOLOR_WHITE;
+	pattern = pattern_get(mode);
+	if (!pattern) {
+		mode = 0U;
+		pattern = pattern_get(mode);
 	}
 	previous_mode = atomic_set(&m_mode, mode);
-	m_pattern_interface.selected_color = m_context_data.pattern_context[m_mode];
-	switch (m_mode) {
-		case LED_PLAYER_MODE_UNICOLOR_WHITE:
-			pattern_is_unicolor_white_cold(&m_pattern_interface);
-			led_player_set_color(32U);
-		break;
-		case LED_PLAYER_MODE_UNICOLOR_WARM:
-			pattern_is_unicolor_white_warm(&m_pattern_interface);
-			led_player_set_color(32U);
-		break;
-
-		case LED_PLAYER_MODE_UNICOLOR_CUSTOM:
-			pattern_is_unicolor_custom(&m_pattern_interface);
-			led_player_set_color(32U);
-		break;
-
-		case LED_PLAYER_MODE_RAINBOW:
-			pattern_is_rainbow(&m_pattern_interface);
-			led_player_set_color(32U);
-		break;
-		case LED_PLAYER_MODE_UNISHINE:
-
-		break;
-		default:
-
-		break;
+	mark_dirty();
+	if (m_pattern) {
+		/* Previous pattern keeps running, and is released, until faded out */
+		transition_start(&m_transition, m_pattern, pattern, m_color_ramp.value,
+				 atomic_get(&m_transition_ms));
 	}
+	m_pattern = pattern;
+	m_pattern->init(mode < CONTEXT_PATTERN_CONTEXT_MAX_SIZE ?
+			m_context_data.pattern_context[mode] : 0U);
+	led_player_set_color(32U);
+	/* Incoming pattern fades in with its own color, no color ramp on top */
+	ramp_init(&m_color_ramp, ramp_lerp_rgb, atomic_get(&m_color));
 	if (m_context_data.mode != m_mode) {
 		m_context_data.mode = m_mode;
 		k_work_reschedule(&work, K_SECONDS(10));
 	}
-	LOG_INF("led_player_set_mode %d previous was %d", mode, previous_mode);
+	LOG_INF("led_player_set_mode %s (%d) previous was %d", m_pattern->name, mode, previous_mode);
 	k_mutex_unlock(&m_generic_mutex);
 }
 
-enum led_player_mode led_player_get_mode(void)
+uint32_t led_player_get_mode(void)
 {
 	LOG_INF("led_player_get_mode");
 	return atomic_get(&m_mode);
 }
 
+size_t led_player_get_mode_count(void)
+{
+	return pattern_count();
+}
+
+const char *led_player_get_mode_name(uint32_t mode)
+{
+	const struct pattern_descriptor *pattern = pattern_get(mode);
+
+	return pattern ? pattern->name : NULL;
+}
+
 void led_player_increment_mode(void)
 {
 	k_mutex_lock(&m_generic_mutex, K_FOREVER);
-	enum led_player_mode mode = led_player_get_mode();
+	uint32_t mode = led_player_get_mode();
 	++mode;
 	led_player_set_mode(mode);
 	k_mutex_unlock(&m_generic_mutex);
@@ -226,12 +708,15 @@ void led_player_set_color(uint32_t color)
 	k_mutex_lock(&m_generic_mutex, K_FOREVER);
 	uint32_t co;
 	uint32_t selected;
-	m_pattern_interface.set_color(&co, &selected);
+	m_pattern->set_color(&co, &selected);
 	// m_context_data.pattern_context[m_mode] = selected;
 	uint32_t previous_mode = atomic_set(&m_color, co);
+	set_color_target(co);
+	mark_dirty();
 	LOG_INF("led_player_set_color %d previous was %d", color, previous_mode);
 
-	if (m_context_data.pattern_context[m_mode] != selected) {
+	if (m_mode < CONTEXT_PATTERN_CONTEXT_MAX_SIZE &&
+	    m_context_data.pattern_context[m_mode] != selected) {
 		m_context_data.pattern_context[m_mode] = selected;
 		k_work_reschedule(&work, K_SECONDS(10));
 	}
@@ -249,7 +734,9 @@ uint32_t led_player_get_color(void)
 void led_player_increment_color(uint32_t step)
 {
 	uint32_t color = led_player_get_color();
-	m_pattern_interface.increment_color();
+	k_mutex_lock(&m_generic_mutex, K_FOREVER);
+	m_pattern->increment_color();
+	k_mutex_unlock(&m_generic_mutex);
 	// color = hsv_to_rgb32(hub);
 	led_player_set_color(color);
 	// LOG_INF("led_player_increment_color %d previous was %d", color, previous_color);
@@ -259,6 +746,7 @@ void led_player_set_speed(const uint8_t speed)
 {
 	k_mutex_lock(&m_generic_mutex, K_FOREVER);
 	uint32_t previous_mode = atomic_set(&m_speed, speed);
+	mark_dirty();
 	LOG_INF("led_player_set_speed %d previous was %d", speed, previous_mode);
 	// k_condvar_signal(&m_generic_state_cond);
 	k_mutex_unlock(&m_generic_mutex);
@@ -277,6 +765,8 @@ void led_player_set_brightness(uint8_t brightness)
 	}
 	k_mutex_lock(&m_generic_mutex, K_FOREVER);
 	uint32_t previous_mode = atomic_set(&m_brightness, brightness);
+	set_brightness_target(brightness);
+	mark_dirty();
 	LOG_INF("led_player_set_brightness %d previous was %d", brightness, previous_mode);
 	// k_condvar_signal(&m_generic_state_cond);
 	if (m_context_data.brightness != m_brightness) {
@@ -308,6 +798,106 @@ void led_player_increment_brightness(uint8_t step)
 	// k_mutex_unlock(&m_generic_mutex);
 }
 
+int led_player_set_fps(uint8_t fps)
+{
+	if (fps == 0U || fps > LED_PLAYER_FPS_MAX) {
+		return -EINVAL;
+	}
+
+	uint32_t previous_fps = atomic_set(&m_fps, fps);
+	if (previous_fps != fps) {
+		start_frame_timer(fps);
+	}
+	LOG_INF("led_player_set_fps %d previous was %d", fps, previous_fps);
+
+	return 0;
+}
+
+uint8_t led_player_get_fps(void)
+{
+	return atomic_get(&m_fps);
+}
+
+int led_player_set_length(size_t length)
+{
+	int err;
+
+	if (length == 0U) {
+		return -EINVAL;
+	}
+
+	if (!thread_id) {
+		return -EAGAIN;
+	}
+
+	k_mutex_lock(&m_resize_mutex, K_FOREVER);
+	atomic_set(&m_resize_length, length);
+	k_sem_take(&m_resize_done, K_FOREVER);
+	err = m_resize_result;
+	k_mutex_unlock(&m_resize_mutex);
+
+	return err;
+}
+
+size_t led_player_get_length(void)
+{
+	return led_numbers;
+}
+
+void led_player_get_stats(struct led_player_stats *stats)
+{
+	stats->frames = atomic_get(&m_frames);
+	stats->missed_deadlines = atomic_get(&m_missed_deadlines);
+	stats->skipped_frames = atomic_get(&m_skipped_frames);
+	stats->rotated_frames = atomic_get(&m_rotated_frames);
+	stats->prefix_frames = atomic_get(&m_prefix_frames);
+	stats->render_us = atomic_get(&m_render_us);
+	stats->render_us_max = atomic_get(&m_render_us_max);
+	k_mutex_lock(&m_generic_mutex, K_FOREVER);
+	stats->blend_us = m_transition.blend_us;
+	stats->blend_us_max = m_transition.blend_us_max;
+	k_mutex_unlock(&m_generic_mutex);
+}
+
+int led_player_set_transition(uint16_t duration_ms)
+{
+	if (duration_ms > TRANSITION_DURATION_MAX_MS) {
+		return -EINVAL;
+	}
+
+	atomic_set(&m_transition_ms, duration_ms);
+	LOG_INF("led_player_set_transition %u ms", duration_ms);
+
+	return 0;
+}
+
+uint16_t led_player_get_transition(void)
+{
+	return atomic_get(&m_transition_ms);
+}
+
+int led_player_set_ramp(uint16_t duration_ms, enum ramp_easing easing)
+{
+	if (duration_ms > RAMP_DURATION_MAX_MS || easing >= RAMP_EASING_COUNT) {
+		return -EINVAL;
+	}
+
+	atomic_set(&m_ramp_ms, duration_ms);
+	atomic_set(&m_ramp_easing, easing);
+	LOG_INF("led_player_set_ramp %u ms easing %d", duration_ms, easing);
+
+	return 0;
+}
+
+uint16_t led_player_get_ramp(enum ramp_easing *easing)
+{
+	if (easing) {
+		*easing = atomic_get(&m_ramp_easing);
+	}
+
+	return atomic_get(&m_ramp_ms);
+}
+
 #include <zephyr/shell/shell.h>
 
 static bool string_to_uint32(const char *str, uint32_t *res)
@@ -368,7 +958,319 @@ static int set_custom_color(const struct shell *sh, size_t argc, char **argv)
 	LOG_INF("color %x", color);
 	// uint32_t color = hsv_to_rgb32(value);
 	// led_player_set_color(color);
+	k_mutex_lock(&m_generic_mutex, K_FOREVER);
 	atomic_set(&m_color, color);
+	set_color_target(color);
+	mark_dirty();
+	k_mutex_unlock(&m_generic_mutex);
+	return 0;
+}
+
+static int fps(const struct shell *sh, size_t argc, char **argv)
+{
+	uint32_t value;
+
+	if (argc < 2) {
+		shell_print(sh, "FPS: %u", led_player_get_fps());
+		return 0;
+	}
+
+	if (!string_to_uint32(argv[1], &value) || value > UINT8_MAX) {
+		shell_error(sh, "Error while converting to uint8_t");
+		return -EINVAL;
+	}
+
+	if (led_player_set_fps(value)) {
+		shell_error(sh, "FPS must be between 1 and %u", LED_PLAYER_FPS_MAX);
+		return -EINVAL;
+	}
+	shell_print(sh, "OK:%u", value);
+
+	return 0;
+}
+
+static int length(const struct shell *sh, size_t argc, char **argv)
+{
+	uint32_t value;
+	int err;
+
+	if (argc < 2) {
+		shell_print(sh, "Length: %u", led_player_get_length());
+		return 0;
+	}
+
+	if (!string_to_uint32(argv[1], &value)) {
+		shell_error(sh, "Error while converting to uint32_t");
+		return -EINVAL;
+	}
+
+	err = led_player_set_length(value);
+	if (err) {
+		shell_error(sh, "Failed to resize to %u LEDs (%d)", value, err);
+		return err;
+	}
+	shell_print(sh, "OK:%u", value);
+
+	return 0;
+}
+
+static int speed(const struct shell *sh, size_t argc, char **argv)
+{
+	uint32_t value;
+
+	if (argc < 2) {
+		shell_print(sh, "Speed: %u", led_player_get_speed());
+		return 0;
+	}
+
+	if (!string_to_uint32(argv[1], &value) || value > UINT8_MAX) {
+		shell_error(sh, "Error while converting to uint8_t");
+		return -EINVAL;
+	}
+
+	led_player_set_speed(value);
+	shell_print(sh, "OK:%u", value);
+
+	return 0;
+}
+
+static int fade(const struct shell *sh, size_t argc, char **argv)
+{
+	uint32_t value;
+
+	if (argc < 2) {
+		shell_print(sh, "Transition: %u ms", led_player_get_transition());
+		return 0;
+	}
+
+	if (!string_to_uint32(argv[1], &value) || value > UINT16_MAX ||
+	    led_player_set_transition(value)) {
+		shell_error(sh, "Transition must be at most %u ms", TRANSITION_DURATION_MAX_MS);
+		return -EINVAL;
+	}
+	shell_print(sh, "OK:%u", value);
+
+	return 0;
+}
+
+static int ramp(const struct shell *sh, size_t argc, char **argv)
+{
+	static const char *const easings[RAMP_EASING_COUNT] = {
+		[RAMP_EASING_LINEAR] = "linear",
+		[RAMP_EASING_EASE_IN] = "in",
+		[RAMP_EASING_EASE_OUT] = "out",
+		[RAMP_EASING_EASE_IN_OUT] = "inout",
+	};
+	enum ramp_easing easing;
+	uint32_t value;
+	int i;
+
+	if (argc < 2) {
+		value = led_player_get_ramp(&easing);
+		shell_print(sh, "Ramp: %u ms %s", value, easings[easing]);
+		return 0;
+	}
+
+	if (!string_to_uint32(argv[1], &value) || value > RAMP_DURATION_MAX_MS) {
+		shell_error(sh, "Ramp must be at most %u ms", RAMP_DURATION_MAX_MS);
+		return -EINVAL;
+	}
+
+	led_player_get_ramp(&easing);
+	if (argc > 2) {
+		for (i = 0; i < RAMP_EASING_COUNT; i++) {
+			if (!strcmp(argv[2], easings[i])) {
+				break;
+			}
+		}
+		if (i == RAMP_EASING_COUNT) {
+			shell_error(sh, "Easing is linear, in, out or inout");
+			return -EINVAL;
+		}
+		easing = i;
+	}
+
+	led_player_set_ramp(value, easing);
+	shell_print(sh, "OK:%u %s", value, easings[easing]);
+
+	return 0;
+}
+
+static int stats(const struct shell *sh, size_t argc, char **argv)
+{
+	struct led_player_stats current;
+	struct frame_arena_stats arena;
+
+	ARG_UNUSED(argc);
+	ARG_UNUSED(argv);
+
+	led_player_get_stats(&current);
+	shell_print(sh, "fps: %u", led_player_get_fps());
+	shell_print(sh, "frames: %u", current.frames);
+	shell_print(sh, "missed deadlines: %u", current.missed_deadlines);
+	shell_print(sh, "skipped frames: %u", current.skipped_frames);
+	shell_print(sh, "rotated frames: %u", current.rotated_frames);
+	shell_print(sh, "prefix frames: %u", current.prefix_frames);
+	shell_print(sh, "render: %u us (max %u us)", current.render_us, current.render_us_max);
+	shell_print(sh, "blend: %u us (max %u us)", current.blend_us, current.blend_us_max);
+	if (frame_arena_get_stats(&arena) == 0) {
+		shell_print(sh, "arena: %u/%u bytes (peak %u)", arena.used, arena.size, arena.peak);
+	}
+
+	return 0;
+}
+
+/* Frame width the driver picks from the devicetree frames */
+static uint8_t ws2812_frame_bits(const struct led_backend_ws2812 *strip)
+{
+	const uint8_t frames = strip->one_frame | strip->zero_frame;
+
+	return frames < BIT(3) ? 3U : frames < BIT(4) ? 4U : 8U;
+}
+
+static const struct ws2812_timing_spec *ws2812_spec_find(const char *name)
+{
+	for (size_t i = 0; i < ws2812_timing_spec_count; i++) {
+		if (strcmp(name, ws2812_timing_specs[i].name) == 0) {
+			return &ws2812_timing_specs[i];
+		}
+	}
+
+	return NULL;
+}
+
+static int timing_check_strip(const struct shell *sh, const struct led_backend_ws2812 *strip,
+			      const struct ws2812_timing_spec *spec)
+{
+	/* All zeros, all ones and alternating bits, in wire order */
+	static const uint8_t probe[] = { 0x00, 0xff, 0xa5 };
+	const struct ws2812_bus_limits limits = {
+		.src_clock = CONFIG_APP_WS2812_SPI_SRC_CLOCK_HZ,
+		.max_frequency = strip->max_frequency,
+		.margin_ns = CONFIG_APP_WS2812_TIMING_MARGIN_NS,
+	};
+	struct ws2812_encoding enc = {
+		.frame_bits = ws2812_frame_bits(strip),
+		.one_frame = strip->one_frame,
+		.zero_frame = strip->zero_frame,
+	};
+	uint8_t buf[sizeof(probe) * 8U];
+	struct ws2812_pulse pulses[sizeof(probe) * 8U];
+	uint8_t decoded[sizeof(probe)];
+	int count;
+	int bad;
+
+	enc.frequency = ws2812_timing_bus_frequency(enc.frame_bits, limits.max_frequency,
+						    limits.src_clock);
+	shell_print(sh, "%s as %s: %u-bit frames at %u Hz, one 0x%x zero 0x%x", strip->node,
+		    spec->name, enc.frame_bits, enc.frequency, enc.one_frame, enc.zero_frame);
+
+	ws2812_timing_encode(&enc, probe, ARRAY_SIZE(probe), buf);
+	count = ws2812_timing_decode(buf, ARRAY_SIZE(probe) * enc.frame_bits, enc.frequency,
+				     pulses, ARRAY_SIZE(pulses));
+	if (count != ARRAY_SIZE(pulses)) {
+		shell_error(sh, "frames decode to %d pulses instead of %zu", count,
+			    ARRAY_SIZE(pulses));
+		return -EINVAL;
+	}
+
+	/* Pulse 0 is a zero bit, pulse 8 a one bit */
+	shell_print(sh, "T0H %u T0L %u T1H %u T1L %u ns", pulses[0].high_ns, pulses[0].low_ns,
+		    pulses[8].high_ns, pulses[8].low_ns);
+	bad = ws2812_timing_check(spec, pulses, count, decoded);
+	if (bad >= 0) {
+		shell_error(sh, "pulse %d out of spec: %u ns high, %u ns low", bad,
+			    pulses[bad].high_ns, pulses[bad].low_ns);
+	} else if (memcmp(decoded, probe, sizeof(probe)) != 0) {
+		shell_error(sh, "bits read back differ");
+	} else {
+		shell_print(sh, "pulses: OK");
+	}
+
+	if (strip->reset_delay < spec->reset_min_us) {
+		shell_error(sh, "reset %u us below %u us", strip->reset_delay, spec->reset_min_us);
+	} else {
+		shell_print(sh, "reset %u us: OK", strip->reset_delay);
+	}
+
+	if (ws2812_timing_tune(spec, &limits, &enc)) {
+		shell_error(sh, "no encoding within %u ns margin", limits.margin_ns);
+		return -ENOENT;
+	}
+	shell_print(sh, "best: %u-bit frames at %u Hz, one 0x%x zero 0x%x, %u bytes per pixel",
+		    enc.frame_bits, enc.frequency, enc.one_frame, enc.zero_frame,
+		    enc.frame_bits * strip->num_colors);
+
+	return 0;
+}
+
+/* Strips of the backend in use, each checked against its own chipset unless one is given */
+static int timing(const struct shell *sh, size_t argc, char **argv)
+{
+	const struct ws2812_timing_spec *spec = NULL;
+	int err = 0;
+
+	if (!m_backend || m_backend->ws2812_count == 0U) {
+		shell_error(sh, "No WS2812 strip on backend %s", m_backend ? m_backend->name : "-");
+		return -ENOTSUP;
+	}
+
+	if (argc > 1) {
+		spec = ws2812_spec_find(argv[1]);
+		if (!spec) {
+			shell_error(sh, "Unknown chipset %s", argv[1]);
+			return -EINVAL;
+		}
+	}
+
+	for (size_t i = 0; i < m_backend->ws2812_count; i++) {
+		const struct led_backend_ws2812 *strip = &m_backend->ws2812[i];
+		const struct ws2812_timing_spec *strip_spec = spec ? spec :
+							      ws2812_spec_find(strip->spec);
+		int rc = timing_check_strip(sh, strip, strip_spec ? strip_spec :
+								   &ws2812_timing_specs[0]);
+
+		if (rc && !err) {
+			err = rc;
+		}
+	}
+
+	return err;
+}
+
+static int mode(const struct shell *sh, size_t argc, char **argv)
+{
+	uint32_t value;
+
+	if (argc < 2) {
+		shell_print(sh, "Mode: %s (%u)", led_player_get_mode_name(led_player_get_mode()),
+			    led_player_get_mode());
+		return 0;
+	}
+
+	if (!string_to_uint32(argv[1], &value) || value >= led_player_get_mode_count()) {
+		shell_error(sh, "Mode must be below %u", led_player_get_mode_count());
+		return -EINVAL;
+	}
+
+	led_player_set_mode(value);
+	shell_print(sh, "OK:%s", led_player_get_mode_name(value));
+
+	return 0;
+}
+
+static int modes(const struct shell *sh, size_t argc, char **argv)
+{
+	uint32_t index = 0U;
+
+	ARG_UNUSED(argc);
+	ARG_UNUSED(argv);
+
+	STRUCT_SECTION_FOREACH(pattern_descriptor, pattern) {
+		shell_print(sh, "%u: %s%s", index, pattern->name, pattern->is_static ? " (static)" : "");
+		index++;
+	}
+
 	return 0;
 }
 
@@ -387,6 +1289,15 @@ static int increment(const struct shell *sh, size_t argc, char **argv)
 SHELL_STATIC_SUBCMD_SET_CREATE(sub_app, SHELL_CMD_ARG(color, NULL, "set color",
 					     set_custom_color, 4, 0),
 						 SHELL_CMD(inc, NULL, "Get RGBW", increment),
+						 SHELL_CMD_ARG(fps, NULL, "Get/set frame rate", fps, 1, 1),
+						 SHELL_CMD_ARG(length, NULL, "Get/set strip length, until reboot", length, 1, 1),
+						 SHELL_CMD_ARG(speed, NULL, "Get/set animation speed", speed, 1, 1),
+						 SHELL_CMD_ARG(ramp, NULL, "Get/set brightness and color ramp: <ms> [linear|in|out|inout]", ramp, 1, 2),
+						 SHELL_CMD_ARG(fade, NULL, "Get/set pattern transition in ms", fade, 1, 1),
+						 SHELL_CMD_ARG(mode, NULL, "Get/set pattern", mode, 1, 1),
+						 SHELL_CMD(modes, NULL, "List patterns", modes),
+						 SHELL_CMD(stats, NULL, "Render loop statistics", stats),
+						 SHELL_CMD_ARG(timing, NULL, "Check the WS2812 pulse timings of the strips in use: [ws2812b|sk6812]", timing, 1, 1),
 			       SHELL_SUBCMD_SET_END);
 
 SHELL_CMD_REGISTER(ledstrip, &sub_app, "LED-strip commands", NULL);
@@ -4,14 +4,24 @@
  * SPDX-License-Identifier: Apache-2.0
  */
 
-/**< @brief Generic interface states >*/
-enum led_player_mode {
-	LED_PLAYER_MODE_UNICOLOR_WHITE,
-	LED_PLAYER_MODE_UNICOLOR_WARM,
-	LED_PLAYER_MODE_UNICOLOR_CUSTOM,
-	LED_PLAYER_MODE_RAINBOW,
-	LED_PLAYER_MODE_UNISHINE,
-	LED_PLAYER_MODE_MAX
+#include <led_player/ramp.h>
+
+/**< @brief Render loop statistics >*/
+struct led_player_stats {
+	uint32_t frames;
+	uint32_t missed_deadlines;
+	/* Frames not rendered nor sent because the output did not change */
+	uint32_t skipped_frames;
+	/* Frames sent as the last rendered one rotated, without rendering */
+	uint32_t rotated_frames;
+	/* Frames of which only the changed head of the strip was sent */
+	uint32_t prefix_frames;
+	/* Time spent rendering and encoding the last rendered frame and its maximum */
+	uint32_t render_us;
+	uint32_t render_us_max;
+	/* Time spent blending patterns in the last transition frame and its maximum */
+	uint32_t blend_us;
+	uint32_t blend_us_max;
 };
 
 /////////////////////////////////////
@@ -28,9 +38,17 @@ enum led_player_mode {
 
 int led_player_init(uint32_t *led_length);
 
-void led_player_set_mode(const enum led_player_mode mode);
+int led_player_set_length(size_t length);
 
-enum led_player_mode led_player_get_mode(void);
+size_t led_player_get_length(void);
+
+void led_player_set_mode(uint32_t mode);
+
+uint32_t led_player_get_mode(void);
+
+size_t led_player_get_mode_count(void);
+
+const char *led_player_get_mode_name(uint32_t mode);
 
 void led_player_increment_mode(void);
 
@@ -49,3 +67,17 @@ void led_player_set_brightness(uint8_t brightness);
 uint8_t led_player_get_brightness(void);
 
 void led_player_increment_brightness(uint8_t step);
+
+int led_player_set_fps(uint8_t fps);
+
+uint8_t led_player_get_fps(void);
+
+void led_player_get_stats(struct led_player_stats *stats);
+
+int led_player_set_transition(uint16_t duration_ms);
+
+uint16_t led_player_get_transition(void);
+
+int led_player_set_ramp(uint16_t duration_ms, enum ramp_easing easing);
+
+uint16_t led_player_get_ramp(enum ramp_easing *easing);
@@ -5,12 +5,9 @@
  */
 
 #include <zephyr/kernel.h>
-#include "types/rainbow.h"
-#include "types/unicolor_custom.h"
-#include "types/unicolor_white_cold.h"
-#include "types/unicolor_white_warm.h"
 
 #include "generic.h"
+#include "pixel_ops.h"
 
 #include <zephyr/logging/log.h>
 LOG_MODULE_REGISTER(generic, CONFIG_APP_LOG_LEVEL);
@@ -19,9 +16,6 @@ LOG_MODULE_REGISTER(generic, CONFIG_APP_LOG_LEVEL);
 // Local variables declarations
 /////////////////////////////////////
 
-/**< @brief Generic interface container >*/
-static struct pattern_interface *_m_pattern_iface = NULL;
-
 /////////////////////////////////////
 // Local function declarations
 /////////////////////////////////////
@@ -34,36 +28,70 @@ static struct pattern_interface *_m_pattern_iface = NULL;
 // Functions definition
 /////////////////////////////////////
 
-int pattern_is_rainbow(struct pattern_interface *g_iface)
+size_t pattern_count(void)
 {
-	LOG_WRN("Rainbow selected");
-	_m_pattern_iface = g_iface;
-	return pattern_rainbow_init(g_iface);
+	size_t count;
+
+	STRUCT_SECTION_COUNT(pattern_descriptor, &count);
+
+	return count;
+}
+
+const struct pattern_descriptor *pattern_get(size_t index)
+{
+	struct pattern_descriptor *pattern;
+
+	if (index >= pattern_count()) {
+		return NULL;
+	}
+
+	STRUCT_SECTION_GET(pattern_descriptor, index, &pattern);
+
+	return pattern;
 }
 
-int pattern_is_unicolor_white_cold(struct pattern_interface *g_iface)
+void pattern_advance(const struct pattern_descriptor *pattern, const struct frame_context *ctx)
 {
-	LOG_WRN("Unicolor white cold selected");
-	_m_pattern_iface = g_iface;
-	return pattern_unicolor_white_cold_init(g_iface);
+	if (pattern->advance) {
+		pattern->advance(ctx);
+	}
 }
 
-int pattern_is_unicolor_white_warm(struct pattern_interface *g_iface)
+void pattern_unicolor_process(struct led_rgb *pixel_array, const struct frame_context *ctx)
 {
-	LOG_WRN("Unicolor white warm selected");
-	_m_pattern_iface = g_iface;
-	return pattern_unicolor_white_warm_init(g_iface);
+	const uint8_t *brightness = ctx->brightness;
+	const struct led_rgb color = {
+		.r = brightness[(ctx->color >> 16) & 0xFF],
+		.g = brightness[(ctx->color >> 8) & 0xFF],
+		.b = brightness[ctx->color & 0xFF],
+	};
+
+	pixel_fill(pixel_array, ctx->count, color);
 }
 
-int pattern_is_unicolor_custom(struct pattern_interface *g_iface)
+void pattern_unicolor_process16(struct pattern_rgb16 *pixels, const struct frame_context *ctx)
 {
-	LOG_WRN("Unicolor custom selected");
-	_m_pattern_iface = g_iface;
-	return pattern_unicolor_custom_init(g_iface);
+	const uint16_t *brightness = ctx->brightness16;
+	const struct pattern_rgb16 color = {
+		.r = brightness[(ctx->color >> 16) & 0xFF],
+		.g = brightness[(ctx->color >> 8) & 0xFF],
+		.b = brightness[ctx->color & 0xFF],
+	};
+
+	pixel_fill16(pixels, ctx->count, color);
 }
 
-// cppcheck-suppress unusedFunction
-struct pattern_interface *generic_get_current_pattern(void)
+size_t pattern_unicolor_runs(struct led_strip_run *runs, size_t max_runs,
+			     const struct frame_context *ctx)
 {
-	return _m_pattern_iface;
+	const uint8_t *brightness = ctx->brightness;
+
+	ARG_UNUSED(max_runs);
+
+	runs[0].length = ctx->count;
+	runs[0].color.r = brightness[(ctx->color >> 16) & 0xFF];
+	runs[0].color.g = brightness[(ctx->color >> 8) & 0xFF];
+	runs[0].color.b = brightness[ctx->color & 0xFF];
+
+	return 1U;
 }
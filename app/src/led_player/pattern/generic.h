@@ -7,66 +7,182 @@
 #ifndef GENERIC_H
 #define GENERIC_H
 
+#include <zephyr/kernel.h>
+#include <zephyr/sys/iterable_sections.h>
 #include <zephyr/drivers/led_strip.h>
 
-/**< @brief Generic interface states >*/
+/**< @brief Pattern selection function pointer, restores the persisted color index >*/
+typedef int (*pattern_init_t)(uint32_t selected_color);
 
-/**< @brief Generic interface initialize function pointer >*/
-typedef void (*pattern_process_t)(struct led_rgb *pixel_array, uint8_t brightness, size_t led_numbers, uint32_t color);
+/**< @brief Pattern deselection function pointer, releases what init or process allocated >*/
+typedef void (*pattern_deinit_t)(void);
+
+/**< @brief Fractional bits of frame_context time values >*/
+#define FRAME_TIME_SHIFT	16
+#define FRAME_TIME_ONE		(1UL << FRAME_TIME_SHIFT)
+
+/**< @brief Pixel rendered at 16 bits per channel, Q8.8 with brightness applied >*/
+struct pattern_rgb16 {
+	uint16_t r;
+	uint16_t g;
+	uint16_t b;
+};
+
+/**< @brief Everything a pattern needs to render one frame >*/
+struct frame_context {
+	/* Monotonic time since the player started, seconds in Q16.16, wraps after ~18h */
+	uint32_t time;
+	/* Time elapsed since the previous rendered frame, seconds in Q16.16 */
+	uint32_t delta;
+	/* Animation speed in steps per second, the step is pattern defined, 0 pauses */
+	uint8_t speed;
+	uint32_t color;
+	/* BRIGHTNESS_LUT_SIZE table: output channel = brightness[channel] */
+	const uint8_t *brightness;
+	/* Same table in Q8.8, see BRIGHTNESS_LUT16_SHIFT */
+	const uint16_t *brightness16;
+	size_t led_numbers;
+	/* Span to render: pixels start to start + count - 1 go to pixel_array[0..count - 1] */
+	size_t start;
+	size_t count;
+};
+
+/**< @brief Per frame animation step, called once before the frame spans are rendered
+ * Animations advance by speed * delta so they look the same at any frame rate >*/
+typedef void (*pattern_advance_t)(const struct frame_context *ctx);
+
+/**< @brief Render one span of the frame, may be called several times per frame >*/
+typedef void (*pattern_process_t)(struct led_rgb *pixel_array, const struct frame_context *ctx);
+
+/**< @brief Render one span at 16 bits per channel, with ctx->brightness16 >*/
+typedef void (*pattern_process16_t)(struct pattern_rgb16 *pixels, const struct frame_context *ctx);
+
+/**< @brief Render one span as indices in the frame palette, one byte per pixel >*/
+typedef void (*pattern_process_index8_t)(uint8_t *indices, const struct frame_context *ctx);
+
+/**< @brief Palette of the indices rendered for the current frame, LED_STRIP_PALETTE_SIZE
+ * colors with brightness applied, called once per frame after advance >*/
+typedef const struct led_rgb *(*pattern_palette_t)(const struct frame_context *ctx);
+
+/**< @brief Render one span as RGB565, two bytes per pixel >*/
+typedef void (*pattern_process_rgb565_t)(uint16_t *pixels, const struct frame_context *ctx);
+
+/**< @brief Most runs a pattern may emit for one span >*/
+#define PATTERN_RUNS_MAX	8
+
+/**< @brief Render one span as runs of one color, returns the number of runs written,
+ * at most max_runs, whose lengths add up to ctx->count >*/
+typedef size_t (*pattern_runs_t)(struct led_strip_run *runs, size_t max_runs,
+				 const struct frame_context *ctx);
+
+/**< @brief Rotation in pixels of the current frame relative to a frame rendered at 0,
+ * for patterns whose frames only differ by a rotation >*/
+typedef size_t (*pattern_rotation_t)(void);
+
+/**< @brief Number of leading pixels which may differ from the previous frame, called after
+ * advance, 0 when the frame did not change >*/
+typedef size_t (*pattern_dirty_t)(const struct frame_context *ctx);
 
 /**< @brief Generic interface stop function pointer >*/
 typedef int (*color_backend_t)(uint32_t *color, uint32_t *selected_color);
 
 typedef void (*color_increment_t)(void);
 
-/**< @brief Generic interface structure >*/
-typedef struct pattern_interface {
+/**< @brief Pattern descriptor, one per pattern, kept in ROM >*/
+struct pattern_descriptor {
+	const char *name;
+	pattern_init_t init;
+	pattern_deinit_t deinit;
+	/* NULL for patterns without animation */
+	pattern_advance_t advance;
 	pattern_process_t pattern_process;
+	/* NULL unless the pattern renders at 16 bits, the player then dithers dim frames */
+	pattern_process16_t process16;
+	/* NULL unless the pattern keeps its pixels as palette indices, the strip then
+	 * expands them while encoding. palette is set along */
+	pattern_process_index8_t process_index8;
+	pattern_palette_t palette;
+	/* NULL unless the pattern keeps its pixels as RGB565 */
+	pattern_process_rgb565_t process_rgb565;
+	/* NULL unless spans are made of few uniform zones, the strip then encodes each zone once */
+	pattern_runs_t runs;
+	/* NULL unless frames are the same pixels rotated, the strip can then resend the last one */
+	pattern_rotation_t rotation;
+	/* NULL when the whole frame may change at every advance */
+	pattern_dirty_t dirty;
 	color_backend_t set_color;
 	color_backend_t get_color;
 	color_increment_t increment_color;
-	uint32_t selected_color;
-} pattern_interface_t;
+	/* Output only depends on color, brightness and length, not on time */
+	bool is_static;
+};
+
+/**
+ * @brief Register a pattern in the pattern section
+ * @details Patterns are sorted by variable name in the section, so @p _order
+ *          (two digits) gives the position of the pattern in the mode list.
+ *
+ * @param _order: two digits position in the mode list
+ * @param _name: pattern name
+ * @param ...: struct pattern_descriptor members
+ */
+#define PATTERN_DEFINE(_order, _name, ...)					\
+	const STRUCT_SECTION_ITERABLE(pattern_descriptor,			\
+				      pattern_##_order##_##_name) = {		\
+		.name = #_name,							\
+		__VA_ARGS__							\
+	}
+
+/**
+ * @brief Get the number of registered patterns
+ *
+ * @return size_t number of patterns
+ */
+size_t pattern_count(void);
 
 /**
- * @brief Interface implements ethernet interface
+ * @brief Get a pattern from its position in the mode list
  *
- * @param[inout] g_iface: pointer to generic interface structure
- * @return int 0 OK
+ * @param[in] index: position in the mode list
+ * @return const struct pattern_descriptor * NULL if index is out of range
  */
-int pattern_is_rainbow(struct pattern_interface *g_iface);
+const struct pattern_descriptor *pattern_get(size_t index);
 
 /**
- * @brief Interface implements wifi interface
+ * @brief Advance the animation of a pattern by ctx->delta
  *
- * @param[inout] g_iface: pointer to generic interface structure
- * @return int 0 OK
+ * @param[in] pattern: pattern to advance
+ * @param[in] ctx: frame context
  */
-int pattern_is_unicolor_white_cold(struct pattern_interface *g_iface);
+void pattern_advance(const struct pattern_descriptor *pattern, const struct frame_context *ctx);
 
 /**
- * @brief Interface implements LTE-M/NB-IoT interface
+ * @brief Render a span of ctx->color with brightness applied
+ * @details pattern_process of the patterns showing one color, along with
+ *          pattern_unicolor_process16() and pattern_unicolor_runs().
  *
- * @param[inout] g_iface: pointer to generic interface structure
- * @return int 0 OK
+ * @param[out] pixel_array: ctx->count pixels
+ * @param[in] ctx: frame context
  */
-int pattern_is_unicolor_white_warm(struct pattern_interface *g_iface);
+void pattern_unicolor_process(struct led_rgb *pixel_array, const struct frame_context *ctx);
 
 /**
- * @brief Interface implements LoRa interface
+ * @brief Render a span of ctx->color at 16 bits per channel
  *
- * @param[inout] g_iface: pointer to generic interface structure
- * @return int 0 OK
+ * @param[out] pixels: ctx->count pixels
+ * @param[in] ctx: frame context
  */
-int pattern_is_unicolor_custom(struct pattern_interface *g_iface);
+void pattern_unicolor_process16(struct pattern_rgb16 *pixels, const struct frame_context *ctx);
 
 /**
- * @brief Get current interface
- * @warning not thread safe
+ * @brief Render a span of ctx->color as a single run
  *
- * @param void
- * @return struct pattern_interface pointer to generic interface structure
+ * @param[out] runs: one run
+ * @param[in] max_runs: unused, at least one
+ * @param[in] ctx: frame context
+ * @return size_t 1
  */
-struct pattern_interface *generic_get_current_interface(void);
+size_t pattern_unicolor_runs(struct led_strip_run *runs, size_t max_runs,
+			     const struct frame_context *ctx);
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,106 @@
+/*
+ * Copyright (c) 2024 Romain Pelletant
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#include <zephyr/kernel.h>
+
+#include <led_player/pattern/hsv.h>
+
+/////////////////////////////////////
+// Local variables declarations
+/////////////////////////////////////
+
+/**< @brief Hue circle is split in six sectors >*/
+#define HSV_SECTORS	6U
+
+/**< @brief Channel levels within a sector >*/
+enum hsv_level {
+	HSV_MIN,
+	HSV_MAX,
+	HSV_RISE,
+	HSV_FALL,
+	HSV_LEVELS
+};
+
+/**< @brief Level of each channel (r, g, b) per sector >*/
+static const uint8_t hsv_sectors[HSV_SECTORS][3] = {
+	{HSV_MAX, HSV_RISE, HSV_MIN},	/* red to yellow */
+	{HSV_FALL, HSV_MAX, HSV_MIN},	/* yellow to green */
+	{HSV_MIN, HSV_MAX, HSV_RISE},	/* green to cyan */
+	{HSV_MIN, HSV_FALL, HSV_MAX},	/* cyan to blue */
+	{HSV_RISE, HSV_MIN, HSV_MAX},	/* blue to magenta */
+	{HSV_MAX, HSV_MIN, HSV_FALL},	/* magenta to red */
+};
+
+/////////////////////////////////////
+// Local function declarations
+/////////////////////////////////////
+
+/**
+ * @brief Scale an 8-bit value by an 8-bit fraction (255 is 1.0)
+ *
+ * @param[in] value: value to scale
+ * @param[in] scale: fraction
+ * @return uint8_t scaled value
+ */
+static ALWAYS_INLINE uint8_t scale8(uint8_t value, uint8_t scale);
+
+/**
+ * @brief Conversion kernel shared by single and batch entry points
+ */
+static ALWAYS_INLINE struct led_rgb hsv_kernel(uint16_t hue, uint8_t saturation, uint8_t value);
+
+/////////////////////////////////////
+// Local functions definition
+/////////////////////////////////////
+
+static ALWAYS_INLINE uint8_t scale8(uint8_t value, uint8_t scale)
+{
+	return ((uint16_t)value * (scale + 1U)) >> 8;
+}
+
+static ALWAYS_INLINE struct led_rgb hsv_kernel(uint16_t hue, uint8_t saturation, uint8_t value)
+{
+	/* Sector in the upper bits, position within the sector in the lower ones */
+	const uint32_t position = (uint32_t)hue * HSV_SECTORS;
+	const uint8_t *sector = hsv_sectors[position >> 16];
+	const uint8_t fraction = (position >> 8) & 0xFF;
+	uint8_t level[HSV_LEVELS];
+	struct led_rgb rgb;
+
+	level[HSV_MAX] = value;
+	level[HSV_MIN] = value - scale8(value, saturation);
+	level[HSV_RISE] = level[HSV_MIN] + scale8(level[HSV_MAX] - level[HSV_MIN], fraction);
+	level[HSV_FALL] = level[HSV_MIN] + scale8(level[HSV_MAX] - level[HSV_MIN], 255U - fraction);
+
+	rgb.r = level[sector[0]];
+	rgb.g = level[sector[1]];
+	rgb.b = level[sector[2]];
+
+	return rgb;
+}
+
+/////////////////////////////////////
+// Functions definition
+/////////////////////////////////////
+
+struct led_rgb hsv_to_rgb(uint16_t hue, uint8_t saturation, uint8_t value)
+{
+	return hsv_kernel(hue, saturation, value);
+}
+
+uint32_t hsv_to_rgb32(uint16_t hue)
+{
+	struct led_rgb rgb = hsv_kernel(hue, UINT8_MAX, UINT8_MAX);
+
+	return (rgb.r << 16) | (rgb.g << 8) | rgb.b;
+}
+
+void hsv_to_rgb_span(const uint16_t *hues, struct led_rgb *pixels, size_t count,
+		     uint8_t saturation, uint8_t value)
+{
+	for (size_t i = 0; i < count; i++) {
+		pixels[i] = hsv_kernel(hues[i], saturation, value);
+	}
+}
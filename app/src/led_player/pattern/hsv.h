@@ -0,0 +1,48 @@
+/*
+ * Copyright (c) 2024 Romain Pelletant
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef HSV_H
+#define HSV_H
+
+#include <zephyr/drivers/led_strip.h>
+
+/**< @brief Hue is a 16-bit angle: 0 is red, 0x10000 would be a full turn >*/
+#define HSV_HUE_RED	0x0000U
+#define HSV_HUE_GREEN	0x5555U
+#define HSV_HUE_BLUE	0xAAAAU
+
+/**
+ * @brief Convert one HSV color into RGB
+ * @details Fixed point, no division and no branch on the hue sector
+ *
+ * @param[in] hue: 16-bit hue angle
+ * @param[in] saturation: 0 (grey) to 255 (pure color)
+ * @param[in] value: 0 (off) to 255 (full intensity)
+ * @return struct led_rgb converted color
+ */
+struct led_rgb hsv_to_rgb(uint16_t hue, uint8_t saturation, uint8_t value);
+
+/**
+ * @brief Convert a fully saturated hue into a 0x00RRGGBB color
+ *
+ * @param[in] hue: 16-bit hue angle
+ * @return uint32_t color as 0x00RRGGBB
+ */
+uint32_t hsv_to_rgb32(uint16_t hue);
+
+/**
+ * @brief Convert an array of hues sharing the same saturation and value
+ *
+ * @param[in] hues: array of count 16-bit hue angles
+ * @param[out] pixels: array of count converted colors
+ * @param[in] count: number of hues to convert
+ * @param[in] saturation: 0 (grey) to 255 (pure color)
+ * @param[in] value: 0 (off) to 255 (full intensity)
+ */
+void hsv_to_rgb_span(const uint16_t *hues, struct led_rgb *pixels, size_t count,
+		     uint8_t saturation, uint8_t value);
+
+#endif /* HSV_H */
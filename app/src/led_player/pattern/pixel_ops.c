@@ -0,0 +1,206 @@
+/*
+ * Copyright (c) 2024 Romain Pelletant
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#include <zephyr/kernel.h>
+#include <string.h>
+
+#include <led_player/pattern/pixel_ops.h>
+
+/////////////////////////////////////
+// Local variables declarations
+/////////////////////////////////////
+
+/**< @brief Four channels, may alias the pixel bytes >*/
+typedef uint32_t __attribute__((__may_alias__)) pixel_word_t;
+
+#define WORD_SIZE	sizeof(pixel_word_t)
+
+/**< @brief Even channels of a word, the odd ones are shifted down onto them: each
+ * channel then has 8 free bits above it for a product by up to 256 >*/
+#define EVEN_CHANNELS	0x00FF00FFUL
+#define CHANNEL_LOW	0x7F7F7F7FUL
+#define CHANNEL_HIGH	0x80808080UL
+
+/////////////////////////////////////
+// Local function declarations
+/////////////////////////////////////
+
+/////////////////////////////////////
+// Local functions definition
+/////////////////////////////////////
+
+static inline bool word_aligned(const void *ptr)
+{
+	return ((uintptr_t) ptr & (WORD_SIZE - 1U)) == 0U;
+}
+
+/* Bytes before the first aligned word, at most len */
+static inline size_t head_len(const void *ptr, size_t len)
+{
+	return MIN((WORD_SIZE - ((uintptr_t) ptr & (WORD_SIZE - 1U))) & (WORD_SIZE - 1U), len);
+}
+
+static inline uint32_t scale_word(uint32_t w, uint32_t scale)
+{
+	const uint32_t even = ((w & EVEN_CHANNELS) * scale) >> 8;
+	const uint32_t odd = ((w >> 8) & EVEN_CHANNELS) * scale;
+
+	return (even & EVEN_CHANNELS) | (odd & ~EVEN_CHANNELS);
+}
+
+static inline uint32_t blend_word(uint32_t a, uint32_t b, uint32_t weight)
+{
+	const uint32_t keep = PIXEL_OPS_ONE - weight;
+	const uint32_t even = ((a & EVEN_CHANNELS) * keep + (b & EVEN_CHANNELS) * weight) >> 8;
+	const uint32_t odd = ((a >> 8) & EVEN_CHANNELS) * keep + ((b >> 8) & EVEN_CHANNELS) * weight;
+
+	return (even & EVEN_CHANNELS) | (odd & ~EVEN_CHANNELS);
+}
+
+static inline uint32_t add_saturate_word(uint32_t a, uint32_t b)
+{
+	/* Low 7 bits add without crossing channels, bit 7 is added apart */
+	const uint32_t low = (a & CHANNEL_LOW) + (b & CHANNEL_LOW);
+	const uint32_t sum = low ^ ((a ^ b) & CHANNEL_HIGH);
+	const uint32_t carry = ((a & b) | ((a | b) & low)) & CHANNEL_HIGH;
+
+	/* 0xFF in every channel that carried out */
+	return sum | ((carry >> 7) * 0xFFU);
+}
+
+static void scale_bytes(uint8_t *bytes, size_t len, uint32_t scale)
+{
+	const size_t head = head_len(bytes, len);
+	size_t i;
+
+	for (i = 0; i < head; i++) {
+		bytes[i] = (bytes[i] * scale) >> 8;
+	}
+
+	for (; i + WORD_SIZE <= len; i += WORD_SIZE) {
+		pixel_word_t *w = (pixel_word_t *) &bytes[i];
+
+		*w = scale_word(*w, scale);
+	}
+
+	for (; i < len; i++) {
+		bytes[i] = (bytes[i] * scale) >> 8;
+	}
+}
+
+/* Fill with a pixel of size bytes: four pixels make size whole words. Inlined so that
+ * size is a constant and the block copy unrolls */
+static ALWAYS_INLINE void fill_pixels(uint8_t *dst, size_t count, const uint8_t *pixel, size_t size)
+{
+	union {
+		pixel_word_t w[sizeof(struct pattern_rgb16)];
+		uint8_t bytes[sizeof(struct pattern_rgb16) * WORD_SIZE];
+	} block;
+	pixel_word_t *w;
+	size_t i = 0U;
+
+	/* 3-byte pixels align within 4 pixels, 6-byte ones only from an even address */
+	for (; i < count && i < WORD_SIZE && !word_aligned(&dst[i * size]); i++) {
+		memcpy(&dst[i * size], pixel, size);
+	}
+
+	if (word_aligned(&dst[i * size]) && size <= ARRAY_SIZE(block.w)) {
+		for (size_t p = 0; p < WORD_SIZE; p++) {
+			memcpy(&block.bytes[p * size], pixel, size);
+		}
+
+		w = (pixel_word_t *) &dst[i * size];
+		for (; i + WORD_SIZE <= count; i += WORD_SIZE) {
+			for (size_t k = 0; k < size; k++) {
+				*w++ = block.w[k];
+			}
+		}
+	}
+
+	for (; i < count; i++) {
+		memcpy(&dst[i * size], pixel, size);
+	}
+}
+
+/////////////////////////////////////
+// Functions definition
+/////////////////////////////////////
+
+void pixel_fill(struct led_rgb *pixels, size_t count, struct led_rgb color)
+{
+	fill_pixels((uint8_t *) pixels, count, (const uint8_t *) &color, sizeof(color));
+}
+
+void pixel_fill16(struct pattern_rgb16 *pixels, size_t count, struct pattern_rgb16 color)
+{
+	fill_pixels((uint8_t *) pixels, count, (const uint8_t *) &color, sizeof(color));
+}
+
+void pixel_scale(struct led_rgb *pixels, size_t count, uint16_t scale)
+{
+	if (scale >= PIXEL_OPS_ONE) {
+		return;
+	}
+
+	scale_bytes((uint8_t *) pixels, count * sizeof(*pixels), scale);
+}
+
+void pixel_fade_to_black(struct led_rgb *pixels, size_t count, uint8_t amount)
+{
+	pixel_scale(pixels, count, PIXEL_OPS_ONE - amount);
+}
+
+void pixel_blend(struct led_rgb *pixels, const struct led_rgb *other, size_t count,
+		 uint16_t weight)
+{
+	uint8_t *a = (uint8_t *) pixels;
+	const uint8_t *b = (const uint8_t *) other;
+	const size_t len = count * sizeof(*pixels);
+	const uint32_t keep = PIXEL_OPS_ONE - MIN(weight, PIXEL_OPS_ONE);
+	/* Both spans reach a word boundary together, or never */
+	const size_t head = ((uintptr_t) a ^ (uintptr_t) b) & (WORD_SIZE - 1U) ?
+			    len : head_len(a, len);
+	size_t i;
+
+	weight = PIXEL_OPS_ONE - keep;
+
+	for (i = 0; i < head; i++) {
+		a[i] = (a[i] * keep + b[i] * weight) >> 8;
+	}
+
+	for (; i + WORD_SIZE <= len; i += WORD_SIZE) {
+		pixel_word_t *wa = (pixel_word_t *) &a[i];
+
+		*wa = blend_word(*wa, *(const pixel_word_t *) &b[i], weight);
+	}
+
+	for (; i < len; i++) {
+		a[i] = (a[i] * keep + b[i] * weight) >> 8;
+	}
+}
+
+void pixel_add_saturate(struct led_rgb *pixels, const struct led_rgb *other, size_t count)
+{
+	uint8_t *a = (uint8_t *) pixels;
+	const uint8_t *b = (const uint8_t *) other;
+	const size_t len = count * sizeof(*pixels);
+	const size_t head = ((uintptr_t) a ^ (uintptr_t) b) & (WORD_SIZE - 1U) ?
+			    len : head_len(a, len);
+	size_t i;
+
+	for (i = 0; i < head; i++) {
+		a[i] = MIN(a[i] + b[i], UINT8_MAX);
+	}
+
+	for (; i + WORD_SIZE <= len; i += WORD_SIZE) {
+		pixel_word_t *wa = (pixel_word_t *) &a[i];
+
+		*wa = add_saturate_word(*wa, *(const pixel_word_t *) &b[i]);
+	}
+
+	for (; i < len; i++) {
+		a[i] = MIN(a[i] + b[i], UINT8_MAX);
+	}
+}
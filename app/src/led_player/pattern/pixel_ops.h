@@ -0,0 +1,81 @@
+/*
+ * Copyright (c) 2024 Romain Pelletant
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef PIXEL_OPS_H
+#define PIXEL_OPS_H
+
+#include <zephyr/drivers/led_strip.h>
+#include <led_player/pattern/generic.h>
+
+/*
+ * Pixel spans processed four channels per 32-bit operation (SIMD within a
+ * register): the RISC-V cores have no SIMD unit, and every operation here
+ * treats all channels alike, so channels are handled as a flat byte array
+ * whatever the pixel size. Unaligned heads and tails, and buffers whose
+ * alignments differ, fall back to the scalar loop.
+ */
+
+/**< @brief Weight and scale unit: 256 keeps a channel as is >*/
+#define PIXEL_OPS_ONE	256U
+
+/**
+ * @brief Set every pixel of a span to one color
+ *
+ * @param[out] pixels: span to fill
+ * @param[in] count: number of pixels
+ * @param[in] color: color to set
+ */
+void pixel_fill(struct led_rgb *pixels, size_t count, struct led_rgb color);
+
+/**
+ * @brief 16-bit version of pixel_fill()
+ *
+ * @param[out] pixels: span to fill
+ * @param[in] count: number of pixels
+ * @param[in] color: color to set
+ */
+void pixel_fill16(struct pattern_rgb16 *pixels, size_t count, struct pattern_rgb16 color);
+
+/**
+ * @brief Scale every channel: channel = channel * scale / 256
+ *
+ * @param[inout] pixels: span to scale
+ * @param[in] count: number of pixels
+ * @param[in] scale: 0 (black) to PIXEL_OPS_ONE (unchanged)
+ */
+void pixel_scale(struct led_rgb *pixels, size_t count, uint16_t scale);
+
+/**
+ * @brief Dim every channel toward black: channel = channel * (256 - amount) / 256
+ *
+ * @param[inout] pixels: span to fade
+ * @param[in] count: number of pixels
+ * @param[in] amount: 0 (unchanged) to 255
+ */
+void pixel_fade_to_black(struct led_rgb *pixels, size_t count, uint8_t amount);
+
+/**
+ * @brief Blend a span toward another one
+ * @details channel = (channel * (256 - weight) + other * weight) / 256
+ *
+ * @param[inout] pixels: span to blend, weight 256 - weight
+ * @param[in] other: span blended in, weight weight
+ * @param[in] count: number of pixels
+ * @param[in] weight: 0 (pixels) to PIXEL_OPS_ONE (other)
+ */
+void pixel_blend(struct led_rgb *pixels, const struct led_rgb *other, size_t count,
+		 uint16_t weight);
+
+/**
+ * @brief Add a span to another one, channels saturate at 255
+ *
+ * @param[inout] pixels: span to add to
+ * @param[in] other: span to add
+ * @param[in] count: number of pixels
+ */
+void pixel_add_saturate(struct led_rgb *pixels, const struct led_rgb *other, size_t count);
+
+#endif /* PIXEL_OPS_H */
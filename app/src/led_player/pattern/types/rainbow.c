@@ -6,7 +6,8 @@
 #include <zephyr/kernel.h>
 
 #include <led_player/pattern/generic.h>
-#include <led_player/pattern/types/rainbow.h>
+#include <led_player/brightness.h>
+#include <led_player/frame_arena.h>
 #include <zephyr/drivers/led_strip.h>
 
 #include <zephyr/logging/log.h>
@@ -14,6 +15,25 @@ LOG_MODULE_REGISTER(rainbow, CONFIG_APP_LOG_LEVEL);
 
 #define COLOR_MAX	255U
 
+/**< @brief Gradient is split in three segments: blue to red, red to green, green to blue >*/
+#define RAINBOW_SEGMENTS	3
+/**< @brief Gradient positions, 256 steps per segment >*/
+#define RAINBOW_POSITIONS	(RAINBOW_SEGMENTS * 256U)
+
+enum rainbow_level {
+	RAINBOW_OFF,
+	RAINBOW_RISE,
+	RAINBOW_FALL,
+	RAINBOW_LEVELS
+};
+
+/**< @brief Level of each channel (r, g, b) along a segment >*/
+static const uint8_t rainbow_segments[RAINBOW_SEGMENTS][3] = {
+	{RAINBOW_RISE, RAINBOW_OFF, RAINBOW_FALL},
+	{RAINBOW_FALL, RAINBOW_RISE, RAINBOW_OFF},
+	{RAINBOW_OFF, RAINBOW_FALL, RAINBOW_RISE},
+};
+
 typedef struct {
     char name[30];  // Nom de la couleur
     uint32_t hex; // Code hexadécimal
@@ -36,6 +56,36 @@ const static uint8_t num_colors = sizeof(rainbow_colors) / sizeof(rainbow_colors
 
 static uint8_t m_current_color = 0U;
 
+/**< @brief Gradient cached per length, as one palette index per pixel >*/
+static uint8_t *m_ramp = NULL;
+static size_t m_ramp_length = 0U;
+
+/**< @brief Gradient colors before brightness, cached per color mask >*/
+static struct led_rgb m_gradient[LED_STRIP_PALETTE_SIZE];
+
+/**< @brief Gradient colors, cached per brightness and color mask: a brightness ramp
+ * only rebuilds LED_STRIP_PALETTE_SIZE colors whatever the length >*/
+static struct led_rgb m_palette[LED_STRIP_PALETTE_SIZE];
+static bool m_palette_valid = false;
+static uint32_t m_palette_color = 0U;
+static uint8_t m_palette_brightness[BRIGHTNESS_LUT_SIZE];
+
+/**< @brief Rotation of the ramp on the strip, in pixels >*/
+static size_t m_offset = 0U;
+/**< @brief Phase accumulator: fraction of pixel not applied to m_offset yet, Q16 >*/
+static uint32_t m_phase = 0U;
+/**< @brief Whether the last advance moved the ramp >*/
+static bool m_moved = false;
+
+/**< @brief Gradient position of consecutive pixels of a span >*/
+struct rainbow_walk {
+	size_t led_numbers;
+	size_t pixel;
+	size_t position;
+	/* Fraction of position, in 1 / led_numbers */
+	size_t remainder;
+};
+
 /////////////////////////////////////
 // Local function declarations
 /////////////////////////////////////
@@ -46,7 +96,7 @@ static uint8_t m_current_color = 0U;
  * @param void
  * @return int 0 OK
  */
-static void rainbow_process(struct led_rgb *pixel_array, uint8_t brightness, size_t led_numbers, uint32_t color);
+static void rainbow_process(struct led_rgb *pixel_array, const struct frame_context *ctx);
 
 /////////////////////////////////////
 // Local functions definition
@@ -85,74 +135,268 @@ static void rainbow_increment_color(void)
     ++m_current_color;
 }
 
-static void rainbow_process(struct led_rgb *pixel_array, uint8_t brightness, size_t led_numbers, uint32_t color)
+static int rainbow_build_ramp(size_t led_numbers)
 {
-	static uint32_t j;
-	uint16_t red = 0U;
-	uint16_t green = 0U;
-	uint16_t blue = 0U;
-	const int segment_size = led_numbers / 3;
-	int k = 0;
-	int l = 0;
-	int m = 0;
+	uint8_t *ramp = frame_arena_realloc(m_ramp, led_numbers);
 
+	if (!ramp) {
+		LOG_ERR("Failed to allocate rainbow ramp");
+		return -ENOMEM;
+	}
+	m_ramp = ramp;
+	m_ramp_length = led_numbers;
+	m_offset = 0U;
+
+	/* The whole palette spreads over the strip */
+	for (size_t p = 0; p < led_numbers; p++) {
+		m_ramp[p] = (p * LED_STRIP_PALETTE_SIZE) / led_numbers;
+	}
+
+	return 0;
+}
+
+/* Channels left on by the color mask */
+static struct led_rgb rainbow_mask(uint32_t color)
+{
 	/* Color argument is just used to disable a specific color */
-	uint8_t target_r = (color >> 16) & 0xFF;
-	uint8_t target_g = (color >> 8) & 0xFF;
-	uint8_t target_b = color & 0xFF;
-
-	for (int i = 0; i < led_numbers; i++) {
-		if ( ( i >= 0 ) && ( i < led_numbers * 1 / 3 ) ) {
-			red = COLOR_MAX * k / segment_size;
-			green = 0;
-			blue = COLOR_MAX - (COLOR_MAX * k / segment_size );
-			k++;
-			}
-		if ( ( i >= led_numbers * 1 / 3 ) && ( i < led_numbers * 2 / 3 ) ) {
-			red = COLOR_MAX - (COLOR_MAX * l / segment_size );
-			green = COLOR_MAX * l / segment_size;
-			blue = 0;
-			l++;
-		}
-		if ( ( i >= led_numbers * 2 / 3 ) && ( i < led_numbers * 3 / 3 ) ) {
-			red = 0;
-			green = COLOR_MAX - (COLOR_MAX * m / segment_size );
-			blue = COLOR_MAX * m / segment_size;
-			m++;
-		}
-		uint32_t index = (i + j) % led_numbers;
-
-		/* Apply rainbow color palette */
-		red = (target_r == 0) ? 0 : red;
-		green = (target_g == 0) ? 0 : green;
-		blue = (target_b == 0) ? 0 : blue;
-
-		pixel_array[index].r = red / brightness;
-		pixel_array[index].g = green / brightness;
-		pixel_array[index].b = blue / brightness;
-
-	}
-	j = (j + 1) % led_numbers;
-		
+	const struct led_rgb mask = {
+		.r = ((color >> 16) & 0xFF) ? COLOR_MAX : 0U,
+		.g = ((color >> 8) & 0xFF) ? COLOR_MAX : 0U,
+		.b = (color & 0xFF) ? COLOR_MAX : 0U,
+	};
+
+	return mask;
 }
 
-/////////////////////////////////////
-// Functions definition
-/////////////////////////////////////
+/* Gradient color before brightness at position, 0 to RAINBOW_POSITIONS - 1 */
+static struct led_rgb rainbow_color(size_t position, const struct led_rgb *mask)
+{
+	const uint8_t *segment = rainbow_segments[position >> 8];
+	uint8_t level[RAINBOW_LEVELS];
+	struct led_rgb rgb;
+
+	level[RAINBOW_OFF] = 0U;
+	level[RAINBOW_RISE] = position & 0xFF;
+	level[RAINBOW_FALL] = COLOR_MAX - level[RAINBOW_RISE];
+
+	rgb.r = level[segment[0]] & mask->r;
+	rgb.g = level[segment[1]] & mask->g;
+	rgb.b = level[segment[2]] & mask->b;
+
+	return rgb;
+}
+
+static void rainbow_build_gradient(uint32_t color)
+{
+	const struct led_rgb mask = rainbow_mask(color);
+
+	for (size_t i = 0; i < LED_STRIP_PALETTE_SIZE; i++) {
+		m_gradient[i] = rainbow_color(i * RAINBOW_POSITIONS / LED_STRIP_PALETTE_SIZE, &mask);
+	}
+
+	m_palette_color = color;
+}
 
-int pattern_rainbow_init(struct pattern_interface *generic_pattern)
+static void rainbow_build_palette(const uint8_t *brightness)
 {
-	if (!generic_pattern) {
-		LOG_ERR("generic_iface or input_data NULL");
-		return -EFAULT;
+	for (size_t i = 0; i < LED_STRIP_PALETTE_SIZE; i++) {
+		m_palette[i].r = brightness[m_gradient[i].r];
+		m_palette[i].g = brightness[m_gradient[i].g];
+		m_palette[i].b = brightness[m_gradient[i].b];
 	}
 
-	generic_pattern->pattern_process = &rainbow_process;
-	generic_pattern->set_color = rainbow_set_color;
-    generic_pattern->get_color = rainbow_get_color;
-    generic_pattern->increment_color = rainbow_increment_color;
+	m_palette_valid = true;
+	memcpy(m_palette_brightness, brightness, sizeof(m_palette_brightness));
+}
 
-	m_current_color = generic_pattern->selected_color;
+/**< @brief Bring the ramp and palette up to date with the frame context, once per frame >*/
+static int rainbow_update(const struct frame_context *ctx)
+{
+	if (ctx->led_numbers != m_ramp_length && rainbow_build_ramp(ctx->led_numbers)) {
+		/* Black until the next try */
+		memset(m_palette, 0, sizeof(m_palette));
+		memset(m_gradient, 0, sizeof(m_gradient));
+		m_palette_valid = false;
+		return -ENOMEM;
+	}
+
+	if (!m_palette_valid || ctx->color != m_palette_color) {
+		rainbow_build_gradient(ctx->color);
+		rainbow_build_palette(ctx->brightness);
+	} else if (memcmp(ctx->brightness, m_palette_brightness, sizeof(m_palette_brightness))) {
+		rainbow_build_palette(ctx->brightness);
+	}
 
 	return 0;
 }
+
+/* First pixel of the span, the gradient spreads over the strip from m_offset */
+static void rainbow_walk_start(struct rainbow_walk *walk, const struct frame_context *ctx)
+{
+	const size_t pixel = (ctx->start + ctx->led_numbers - m_offset) % ctx->led_numbers;
+
+	walk->led_numbers = ctx->led_numbers;
+	walk->pixel = pixel;
+	walk->position = pixel * RAINBOW_POSITIONS / walk->led_numbers;
+	walk->remainder = pixel * RAINBOW_POSITIONS % walk->led_numbers;
+}
+
+/* Position of the current pixel, then step to the next one without a division */
+static size_t rainbow_walk_next(struct rainbow_walk *walk)
+{
+	const size_t position = walk->position;
+
+	if (++walk->pixel == walk->led_numbers) {
+		walk->pixel = 0U;
+		walk->position = 0U;
+		walk->remainder = 0U;
+		return position;
+	}
+
+	walk->position += RAINBOW_POSITIONS / walk->led_numbers;
+	walk->remainder += RAINBOW_POSITIONS % walk->led_numbers;
+	if (walk->remainder >= walk->led_numbers) {
+		walk->position++;
+		walk->remainder -= walk->led_numbers;
+	}
+
+	return position;
+}
+
+static void rainbow_process_index8(uint8_t *indices, const struct frame_context *ctx)
+{
+	const size_t led_numbers = ctx->led_numbers;
+
+	if (led_numbers == 0U) {
+		return;
+	}
+
+	/* Ramp not allocated: the palette is black */
+	if (m_ramp_length != led_numbers) {
+		memset(indices, 0, ctx->count);
+		return;
+	}
+
+	/* Pixel p shows ramp[(p - m_offset) mod n], a span is at most two runs */
+	size_t src = (ctx->start + led_numbers - m_offset) % led_numbers;
+	size_t done = 0U;
+
+	while (done < ctx->count) {
+		const size_t run = MIN(ctx->count - done, led_numbers - src);
+
+		memcpy(&indices[done], &m_ramp[src], run);
+		done += run;
+		src = 0U;
+	}
+}
+
+static const struct led_rgb *rainbow_palette(const struct frame_context *ctx)
+{
+	ARG_UNUSED(ctx);
+
+	return m_palette;
+}
+
+static void rainbow_process(struct led_rgb *pixel_array, const struct frame_context *ctx)
+{
+	/* Strips without palette support: full gradient precision, no palette banding */
+	const uint8_t *brightness = ctx->brightness;
+	const struct led_rgb mask = rainbow_mask(ctx->color);
+	struct rainbow_walk walk;
+
+	if (ctx->led_numbers == 0U) {
+		return;
+	}
+
+	rainbow_walk_start(&walk, ctx);
+	for (size_t i = 0; i < ctx->count; i++) {
+		const struct led_rgb level = rainbow_color(rainbow_walk_next(&walk), &mask);
+
+		pixel_array[i].r = brightness[level.r];
+		pixel_array[i].g = brightness[level.g];
+		pixel_array[i].b = brightness[level.b];
+	}
+}
+
+static void rainbow_process16(struct pattern_rgb16 *pixels, const struct frame_context *ctx)
+{
+	const uint16_t *brightness = ctx->brightness16;
+	const struct led_rgb mask = rainbow_mask(ctx->color);
+	struct rainbow_walk walk;
+
+	if (ctx->led_numbers == 0U) {
+		return;
+	}
+
+	rainbow_walk_start(&walk, ctx);
+	for (size_t i = 0; i < ctx->count; i++) {
+		const struct led_rgb level = rainbow_color(rainbow_walk_next(&walk), &mask);
+
+		pixels[i].r = brightness[level.r];
+		pixels[i].g = brightness[level.g];
+		pixels[i].b = brightness[level.b];
+	}
+}
+
+static void rainbow_advance(const struct frame_context *ctx)
+{
+	if (ctx->led_numbers == 0U) {
+		return;
+	}
+
+	/* Once per frame, the span hooks only read the ramp and palette */
+	rainbow_update(ctx);
+
+	/* Move speed pixels per second whatever the frame rate, carry the fraction */
+	m_phase += ctx->speed * ctx->delta;
+	m_moved = (m_phase >> FRAME_TIME_SHIFT) % ctx->led_numbers != 0U;
+	m_offset = (m_offset + (m_phase >> FRAME_TIME_SHIFT)) % ctx->led_numbers;
+	m_phase &= FRAME_TIME_ONE - 1U;
+}
+
+static size_t rainbow_dirty(const struct frame_context *ctx)
+{
+	/* Slow speeds move less than a pixel per frame: nothing to send then */
+	return m_moved ? ctx->led_numbers : 0U;
+}
+
+static size_t rainbow_rotation(void)
+{
+	return m_offset;
+}
+
+/////////////////////////////////////
+// Functions definition
+/////////////////////////////////////
+
+static int rainbow_init(uint32_t selected_color)
+{
+	m_current_color = selected_color;
+
+	return 0;
+}
+
+static void rainbow_deinit(void)
+{
+	frame_arena_free(m_ramp);
+	m_ramp = NULL;
+	m_ramp_length = 0U;
+	m_palette_valid = false;
+	m_phase = 0U;
+}
+
+PATTERN_DEFINE(03, rainbow,
+	.init = rainbow_init,
+	.deinit = rainbow_deinit,
+	.advance = rainbow_advance,
+	.pattern_process = &rainbow_process,
+	.process16 = rainbow_process16,
+	.process_index8 = rainbow_process_index8,
+	.palette = rainbow_palette,
+	.rotation = rainbow_rotation,
+	.dirty = rainbow_dirty,
+	.set_color = rainbow_set_color,
+	.get_color = rainbow_get_color,
+	.increment_color = rainbow_increment_color,
+	.is_static = false,
+);
@@ -1,14 +0,0 @@
-/*
- * Copyright (c) 2024 Romain Pelletant
- *
- * SPDX-License-Identifier: Apache-2.0
- */
-
-#ifndef RAINBOW_H
-#define RAINBOW_H
-
-#include <led_player/pattern/generic.h>
-
-int pattern_rainbow_init(struct pattern_interface *generic_pattern);
-
-#endif /* RAINBOW_H */
\ No newline at end of file
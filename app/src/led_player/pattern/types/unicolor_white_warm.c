@@ -5,7 +5,7 @@
  */
 #include <zephyr/kernel.h>
 
-#include <led_player/pattern/types/unicolor_white_warm.h>
+#include <led_player/pattern/generic.h>
 
 #include <zephyr/logging/log.h>
 LOG_MODULE_REGISTER(unicolor_white_warm, CONFIG_APP_LOG_LEVEL);
@@ -39,14 +39,6 @@ static uint8_t m_current_color = 0U;
 // Local function declarations
 /////////////////////////////////////
 
-/**
- * @brief Enable DHCP
- *
- * @param void
- * @return int 0 OK
- */
-static void unicolor_white_warm_process(struct led_rgb *pixel_array, uint8_t brightness, size_t led_numbers, uint32_t color);
-
 /////////////////////////////////////
 // Local functions definition
 /////////////////////////////////////
@@ -84,37 +76,24 @@ static void increment_color(void)
     ++m_current_color;
 }
 
-static void unicolor_white_warm_process(struct led_rgb *pixel_array, uint8_t brightness, size_t led_numbers, uint32_t color)
-{
-	uint8_t target_r = (color >> 16) & 0xFF;
-	uint8_t target_g = (color >> 8) & 0xFF;
-	uint8_t target_b = color & 0xFF;
-
-	for (int i = 0; i < led_numbers; i++) {
-		pixel_array[i].r = target_r/brightness;
-		pixel_array[i].g = target_g/brightness;
-		pixel_array[i].b = target_b/brightness;
-	}
-
-}
-
 /////////////////////////////////////
 // Functions definition
 /////////////////////////////////////
 
-int pattern_unicolor_white_warm_init(struct pattern_interface *generic_pattern)
+static int unicolor_white_warm_init(uint32_t selected_color)
 {
-	if (!generic_pattern) {
-		LOG_ERR("generic_iface or input_data NULL");
-		return -EFAULT;
-	}
-
-	generic_pattern->pattern_process = &unicolor_white_warm_process;
-	generic_pattern->set_color = &set_color;
-    generic_pattern->get_color = &get_color;
-    generic_pattern->increment_color = &increment_color;
-
-    m_current_color = generic_pattern->selected_color;
+    m_current_color = selected_color;
 
 	return 0;
 }
+
+PATTERN_DEFINE(01, unicolor_white_warm,
+	.init = unicolor_white_warm_init,
+	.pattern_process = pattern_unicolor_process,
+	.process16 = pattern_unicolor_process16,
+	.runs = pattern_unicolor_runs,
+	.set_color = &set_color,
+	.get_color = &get_color,
+	.increment_color = &increment_color,
+	.is_static = true,
+);
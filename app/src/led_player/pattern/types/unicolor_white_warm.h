@@ -1,14 +0,0 @@
-/*
- * Copyright (c) 2024 Romain Pelletant
- *
- * SPDX-License-Identifier: Apache-2.0
- */
-
-#ifndef UNICOLOR_WHITE_WARM_H
-#define UNICOLOR_WHITE_WARM_H
-
-#include <led_player/pattern/generic.h>
-
-int pattern_unicolor_white_warm_init(struct pattern_interface *generic_pattern);
-
-#endif /* UNICOLOR_WHITE_WARM_H */
\ No newline at end of file
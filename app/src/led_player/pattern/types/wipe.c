@@ -0,0 +1,183 @@
+/*
+ * Copyright (c) 2024 Romain Pelletant
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#include <zephyr/kernel.h>
+
+#include <led_player/pattern/generic.h>
+#include <led_player/pattern/hsv.h>
+#include <led_player/pattern/pixel_ops.h>
+
+#include <zephyr/logging/log.h>
+LOG_MODULE_REGISTER(wipe, CONFIG_APP_LOG_LEVEL);
+
+/////////////////////////////////////
+// Local variables declarations
+/////////////////////////////////////
+
+static uint16_t m_current_color = 0U;
+
+/**< @brief Pixels before the front show the color while m_lit, the others are off.
+ * Once the front reaches the end, the color is wiped off the same way >*/
+static size_t m_front = 0U;
+static bool m_lit = true;
+/**< @brief Phase accumulator: fraction of pixel not applied to m_front yet, Q16 >*/
+static uint32_t m_phase = 0U;
+/**< @brief Leading pixels changed by the last advance >*/
+static size_t m_dirty = 0U;
+
+/////////////////////////////////////
+// Local function declarations
+/////////////////////////////////////
+
+/////////////////////////////////////
+// Local functions definition
+/////////////////////////////////////
+
+static struct led_rgb wipe_color(const struct frame_context *ctx, bool lit)
+{
+	const uint8_t *brightness = ctx->brightness;
+	const struct led_rgb color = {
+		.r = lit ? brightness[(ctx->color >> 16) & 0xFF] : 0U,
+		.g = lit ? brightness[(ctx->color >> 8) & 0xFF] : 0U,
+		.b = lit ? brightness[ctx->color & 0xFF] : 0U,
+	};
+
+	return color;
+}
+
+/**< @brief Number of pixels of the span before the front >*/
+static size_t wipe_split(const struct frame_context *ctx)
+{
+	return m_front > ctx->start ? MIN(m_front - ctx->start, ctx->count) : 0U;
+}
+
+static void wipe_process(struct led_rgb *pixel_array, const struct frame_context *ctx)
+{
+	const size_t split = wipe_split(ctx);
+
+	pixel_fill(pixel_array, split, wipe_color(ctx, m_lit));
+	pixel_fill(&pixel_array[split], ctx->count - split, wipe_color(ctx, !m_lit));
+}
+
+static size_t wipe_runs(struct led_strip_run *runs, size_t max_runs,
+			const struct frame_context *ctx)
+{
+	const size_t split = wipe_split(ctx);
+	size_t num_runs = 0U;
+
+	ARG_UNUSED(max_runs);
+
+	if (split) {
+		runs[num_runs].length = split;
+		runs[num_runs++].color = wipe_color(ctx, m_lit);
+	}
+	if (ctx->count > split) {
+		runs[num_runs].length = ctx->count - split;
+		runs[num_runs++].color = wipe_color(ctx, !m_lit);
+	}
+
+	return num_runs;
+}
+
+static void wipe_advance(const struct frame_context *ctx)
+{
+	size_t front;
+
+	if (ctx->led_numbers == 0U) {
+		return;
+	}
+
+	/* Strip shortened past the front: start over, the whole frame is sent then */
+	if (m_front >= ctx->led_numbers) {
+		m_front = 0U;
+	}
+
+	/* Move speed pixels per second whatever the frame rate, carry the fraction */
+	m_phase += ctx->speed * ctx->delta;
+	front = m_front + (m_phase >> FRAME_TIME_SHIFT);
+	m_phase &= FRAME_TIME_ONE - 1U;
+
+	if (front == m_front) {
+		m_dirty = 0U;
+		return;
+	}
+
+	/* Only the pixels the front went over changed, unless it wrapped around */
+	m_dirty = front;
+	if (front >= ctx->led_numbers) {
+		m_lit ^= (front / ctx->led_numbers) & 1U;
+		front %= ctx->led_numbers;
+		m_dirty = ctx->led_numbers;
+	}
+	m_front = front;
+}
+
+static size_t wipe_dirty(const struct frame_context *ctx)
+{
+	ARG_UNUSED(ctx);
+
+	return m_dirty;
+}
+
+static int wipe_set_color(uint32_t *color, uint32_t *selected_color)
+{
+	if (!color) {
+		return -EFAULT;
+	}
+
+	*selected_color = m_current_color;
+	*color = hsv_to_rgb32(m_current_color);
+	LOG_INF("selected color %d, index: %d", *color, m_current_color);
+
+	return 0;
+}
+
+static int wipe_get_color(uint32_t *color, uint32_t *selected_color)
+{
+	if (!color) {
+		return -EFAULT;
+	}
+
+	*selected_color = m_current_color;
+	*color = hsv_to_rgb32(m_current_color);
+
+	return 0;
+}
+
+static void wipe_increment_color(void)
+{
+	m_current_color += 750U;
+}
+
+/////////////////////////////////////
+// Functions definition
+/////////////////////////////////////
+
+static int wipe_init(uint32_t selected_color)
+{
+	m_current_color = selected_color;
+
+	return 0;
+}
+
+static void wipe_deinit(void)
+{
+	m_front = 0U;
+	m_lit = true;
+	m_phase = 0U;
+	m_dirty = 0U;
+}
+
+PATTERN_DEFINE(04, wipe,
+	.init = wipe_init,
+	.deinit = wipe_deinit,
+	.advance = wipe_advance,
+	.pattern_process = wipe_process,
+	.runs = wipe_runs,
+	.dirty = wipe_dirty,
+	.set_color = wipe_set_color,
+	.get_color = wipe_get_color,
+	.increment_color = wipe_increment_color,
+);
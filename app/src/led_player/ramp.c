@@ -0,0 +1,118 @@
+/*
+ * Copyright (c) 2024 Romain Pelletant
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#include <zephyr/kernel.h>
+
+#include <led_player/ramp.h>
+
+/////////////////////////////////////
+// Local variables declarations
+/////////////////////////////////////
+
+/////////////////////////////////////
+// Local function declarations
+/////////////////////////////////////
+
+/**
+ * @brief Apply an easing curve to a linear progress
+ *
+ * @param[in] easing: curve
+ * @param[in] t: linear progress in Q16
+ * @return uint32_t eased progress in Q16
+ */
+static uint32_t ramp_ease(enum ramp_easing easing, uint32_t t);
+
+/////////////////////////////////////
+// Local functions definition
+/////////////////////////////////////
+
+static uint32_t ramp_ease(enum ramp_easing easing, uint32_t t)
+{
+	const uint32_t inv = RAMP_PROGRESS_ONE - t;
+
+	switch (easing) {
+	case RAMP_EASING_EASE_IN:
+		/* t^2 */
+		return ((uint64_t) t * t) >> RAMP_PROGRESS_SHIFT;
+	case RAMP_EASING_EASE_OUT:
+		/* 1 - (1 - t)^2 */
+		return RAMP_PROGRESS_ONE - (((uint64_t) inv * inv) >> RAMP_PROGRESS_SHIFT);
+	case RAMP_EASING_EASE_IN_OUT:
+		/* Smoothstep: t^2 (3 - 2t) */
+		return (((uint64_t) t * t >> RAMP_PROGRESS_SHIFT) *
+			(3U * RAMP_PROGRESS_ONE - 2U * t)) >> RAMP_PROGRESS_SHIFT;
+	case RAMP_EASING_LINEAR:
+	default:
+		return t;
+	}
+}
+
+/////////////////////////////////////
+// Functions definition
+/////////////////////////////////////
+
+uint32_t ramp_lerp_scalar(uint32_t from, uint32_t to, uint32_t progress)
+{
+	if (to >= from) {
+		return from + (((uint64_t) (to - from) * progress) >> RAMP_PROGRESS_SHIFT);
+	}
+
+	return from - (((uint64_t) (from - to) * progress) >> RAMP_PROGRESS_SHIFT);
+}
+
+uint32_t ramp_lerp_rgb(uint32_t from, uint32_t to, uint32_t progress)
+{
+	uint32_t color = 0U;
+
+	for (int shift = 0; shift <= 16; shift += 8) {
+		color |= ramp_lerp_scalar((from >> shift) & 0xFF, (to >> shift) & 0xFF, progress)
+			 << shift;
+	}
+
+	return color;
+}
+
+void ramp_init(struct ramp *ramp, ramp_lerp_t lerp, uint32_t value)
+{
+	ramp->lerp = lerp;
+	ramp->from = value;
+	ramp->to = value;
+	ramp->value = value;
+	ramp->elapsed = 0U;
+	ramp->duration = 0U;
+	ramp->easing = RAMP_EASING_LINEAR;
+}
+
+void ramp_set_target(struct ramp *ramp, uint32_t target, uint32_t duration_ms,
+		     enum ramp_easing easing)
+{
+	duration_ms = MIN(duration_ms, RAMP_DURATION_MAX_MS);
+
+	ramp->from = ramp->value;
+	ramp->to = target;
+	ramp->elapsed = 0U;
+	ramp->duration = ((uint64_t) duration_ms << FRAME_TIME_SHIFT) / MSEC_PER_SEC;
+	ramp->easing = easing;
+}
+
+bool ramp_step(struct ramp *ramp, uint32_t delta)
+{
+	const uint32_t previous = ramp->value;
+	uint32_t progress;
+
+	if (ramp->value == ramp->to) {
+		return false;
+	}
+
+	ramp->elapsed = MIN(ramp->elapsed + delta, ramp->duration);
+	if (ramp->elapsed >= ramp->duration) {
+		ramp->value = ramp->to;
+	} else {
+		progress = ((uint64_t) ramp->elapsed << RAMP_PROGRESS_SHIFT) / ramp->duration;
+		ramp->value = ramp->lerp(ramp->from, ramp->to, ramp_ease(ramp->easing, progress));
+	}
+
+	return ramp->value != previous;
+}
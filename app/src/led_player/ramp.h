@@ -0,0 +1,87 @@
+/*
+ * Copyright (c) 2024 Romain Pelletant
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef RAMP_H
+#define RAMP_H
+
+#include <zephyr/kernel.h>
+#include <led_player/pattern/generic.h>
+
+/**< @brief Fractional bits of a ramp progress >*/
+#define RAMP_PROGRESS_SHIFT	16
+#define RAMP_PROGRESS_ONE	(1UL << RAMP_PROGRESS_SHIFT)
+
+/**< @brief Longest ramp in milliseconds >*/
+#define RAMP_DURATION_MAX_MS	5000U
+
+/**< @brief Shape of a ramp over its duration >*/
+enum ramp_easing {
+	RAMP_EASING_LINEAR,
+	RAMP_EASING_EASE_IN,
+	RAMP_EASING_EASE_OUT,
+	RAMP_EASING_EASE_IN_OUT,
+	RAMP_EASING_COUNT
+};
+
+/**< @brief Interpolate between two values, progress is Q16 (0 to RAMP_PROGRESS_ONE) >*/
+typedef uint32_t (*ramp_lerp_t)(uint32_t from, uint32_t to, uint32_t progress);
+
+/**< @brief A parameter moving toward its target >*/
+struct ramp {
+	ramp_lerp_t lerp;
+	uint32_t from;
+	uint32_t to;
+	/* Value to use for the current frame */
+	uint32_t value;
+	/* Seconds in Q16.16, as frame_context time */
+	uint32_t elapsed;
+	uint32_t duration;
+	enum ramp_easing easing;
+};
+
+/**
+ * @brief Interpolate a scalar
+ */
+uint32_t ramp_lerp_scalar(uint32_t from, uint32_t to, uint32_t progress);
+
+/**
+ * @brief Interpolate each channel of a 0xRRGGBB color
+ */
+uint32_t ramp_lerp_rgb(uint32_t from, uint32_t to, uint32_t progress);
+
+/**
+ * @brief Initialize a ramp at rest on a value
+ *
+ * @param[out] ramp: ramp to initialize
+ * @param[in] lerp: interpolation of the ramped parameter
+ * @param[in] value: initial value
+ */
+void ramp_init(struct ramp *ramp, ramp_lerp_t lerp, uint32_t value);
+
+/**
+ * @brief Move the target of a ramp
+ * @details The ramp restarts from its current value, so a target changed
+ *          while ramping does not jump. Only stores state: cheap enough to
+ *          be called from any setter.
+ *
+ * @param[inout] ramp: ramp to update
+ * @param[in] target: new target
+ * @param[in] duration_ms: time to reach the target, 0 jumps at once
+ * @param[in] easing: shape of the ramp
+ */
+void ramp_set_target(struct ramp *ramp, uint32_t target, uint32_t duration_ms,
+		     enum ramp_easing easing);
+
+/**
+ * @brief Advance a ramp by one frame
+ *
+ * @param[inout] ramp: ramp to advance, ramp->value is updated
+ * @param[in] delta: elapsed time in seconds Q16.16
+ * @return true if ramp->value changed
+ */
+bool ramp_step(struct ramp *ramp, uint32_t delta);
+
+#endif /* RAMP_H */
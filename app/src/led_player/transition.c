@@ -0,0 +1,178 @@
+/*
+ * Copyright (c) 2024 Romain Pelletant
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#include <zephyr/kernel.h>
+
+#include <led_player/transition.h>
+#include <led_player/pattern/pixel_ops.h>
+
+#include <zephyr/logging/log.h>
+LOG_MODULE_REGISTER(transition, CONFIG_APP_LOG_LEVEL);
+
+/**< @brief Blend weight of the incoming pattern, 256 is fully incoming >*/
+#define TRANSITION_WEIGHT_SHIFT	8
+#define TRANSITION_WEIGHT_MAX	(1U << TRANSITION_WEIGHT_SHIFT)
+
+BUILD_ASSERT(TRANSITION_WEIGHT_MAX == PIXEL_OPS_ONE, "8-bit blends go through pixel_blend()");
+
+/////////////////////////////////////
+// Local variables declarations
+/////////////////////////////////////
+
+/**< @brief Incoming pattern tile, blended into the outgoing frame >*/
+static union {
+	struct led_rgb rgb[CONFIG_APP_LED_PLAYER_TILE_PIXELS];
+	struct pattern_rgb16 rgb16[CONFIG_APP_LED_PLAYER_TILE_PIXELS];
+} m_tile;
+
+/////////////////////////////////////
+// Local function declarations
+/////////////////////////////////////
+
+/////////////////////////////////////
+// Local functions definition
+/////////////////////////////////////
+
+static inline uint16_t blend_channel16(uint16_t from, uint16_t to, uint32_t weight)
+{
+	return (from * (TRANSITION_WEIGHT_MAX - weight) + to * weight) >> TRANSITION_WEIGHT_SHIFT;
+}
+
+static void blend16(struct pattern_rgb16 *pixels, const struct pattern_rgb16 *tile, size_t count,
+		    uint32_t weight)
+{
+	for (size_t i = 0; i < count; i++) {
+		pixels[i].r = blend_channel16(pixels[i].r, tile[i].r, weight);
+		pixels[i].g = blend_channel16(pixels[i].g, tile[i].g, weight);
+		pixels[i].b = blend_channel16(pixels[i].b, tile[i].b, weight);
+	}
+}
+
+static void transition_end(struct transition *transition)
+{
+	if (transition->from->deinit) {
+		transition->from->deinit();
+	}
+	transition->from = NULL;
+}
+
+/////////////////////////////////////
+// Functions definition
+/////////////////////////////////////
+
+void transition_start(struct transition *transition, const struct pattern_descriptor *from,
+		      const struct pattern_descriptor *to, uint32_t color, uint32_t duration_ms)
+{
+	/* Outgoing pattern of a dropped transition is not rendered anymore */
+	if (transition->from && transition->from != from && transition->from != to) {
+		transition_end(transition);
+	}
+
+	if (from == to) {
+		/* Nothing to fade, and the pattern is still in use */
+		transition->from = NULL;
+		return;
+	}
+
+	duration_ms = MIN(duration_ms, TRANSITION_DURATION_MAX_MS);
+	transition->from = from;
+	transition->color = color;
+	transition->elapsed = 0U;
+	transition->duration = ((uint64_t) duration_ms << FRAME_TIME_SHIFT) / MSEC_PER_SEC;
+
+	if (transition->duration == 0U) {
+		transition_end(transition);
+	}
+}
+
+void transition_advance(struct transition *transition, const struct pattern_descriptor *to,
+			const struct frame_context *ctx)
+{
+	struct frame_context from_ctx = *ctx;
+
+	if (!transition_active(transition)) {
+		pattern_advance(to, ctx);
+		return;
+	}
+
+	transition->elapsed = MIN(transition->elapsed + ctx->delta, transition->duration);
+	if (transition->elapsed >= transition->duration) {
+		transition_end(transition);
+		pattern_advance(to, ctx);
+		return;
+	}
+
+	transition->weight =
+		((uint64_t) transition->elapsed << TRANSITION_WEIGHT_SHIFT) / transition->duration;
+	transition->blend_cycles = 0U;
+
+	from_ctx.color = transition->color;
+	pattern_advance(transition->from, &from_ctx);
+	pattern_advance(to, ctx);
+}
+
+void transition_render_span(struct transition *transition, const struct pattern_descriptor *to,
+			    struct led_rgb *pixel_array, const struct frame_context *ctx)
+{
+	struct frame_context span_ctx = *ctx;
+	uint32_t begin;
+
+	if (!transition_active(transition)) {
+		to->pattern_process(pixel_array, ctx);
+		return;
+	}
+
+	span_ctx.color = transition->color;
+	transition->from->pattern_process(pixel_array, &span_ctx);
+
+	span_ctx.color = ctx->color;
+	for (size_t done = 0U; done < ctx->count; done += ARRAY_SIZE(m_tile.rgb)) {
+		span_ctx.start = ctx->start + done;
+		span_ctx.count = MIN(ARRAY_SIZE(m_tile.rgb), ctx->count - done);
+		to->pattern_process(m_tile.rgb, &span_ctx);
+
+		begin = k_cycle_get_32();
+		pixel_blend(&pixel_array[done], m_tile.rgb, span_ctx.count, transition->weight);
+		transition->blend_cycles += k_cycle_get_32() - begin;
+	}
+
+	transition->blend_us = k_cyc_to_us_floor32(transition->blend_cycles);
+	transition->blend_us_max = MAX(transition->blend_us_max, transition->blend_us);
+}
+
+bool transition_has_process16(const struct transition *transition,
+			      const struct pattern_descriptor *to)
+{
+	return to->process16 && (!transition_active(transition) || transition->from->process16);
+}
+
+void transition_render_span16(struct transition *transition, const struct pattern_descriptor *to,
+			      struct pattern_rgb16 *pixels, const struct frame_context *ctx)
+{
+	struct frame_context span_ctx = *ctx;
+	uint32_t begin;
+
+	if (!transition_active(transition)) {
+		to->process16(pixels, ctx);
+		return;
+	}
+
+	span_ctx.color = transition->color;
+	transition->from->process16(pixels, &span_ctx);
+
+	span_ctx.color = ctx->color;
+	for (size_t done = 0U; done < ctx->count; done += ARRAY_SIZE(m_tile.rgb16)) {
+		span_ctx.start = ctx->start + done;
+		span_ctx.count = MIN(ARRAY_SIZE(m_tile.rgb16), ctx->count - done);
+		to->process16(m_tile.rgb16, &span_ctx);
+
+		begin = k_cycle_get_32();
+		blend16(&pixels[done], m_tile.rgb16, span_ctx.count, transition->weight);
+		transition->blend_cycles += k_cycle_get_32() - begin;
+	}
+
+	transition->blend_us = k_cyc_to_us_floor32(transition->blend_cycles);
+	transition->blend_us_max = MAX(transition->blend_us_max, transition->blend_us);
+}
@@ -0,0 +1,109 @@
+/*
+ * Copyright (c) 2024 Romain Pelletant
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef TRANSITION_H
+#define TRANSITION_H
+
+#include <zephyr/kernel.h>
+#include <led_player/pattern/generic.h>
+
+/**< @brief Longest transition in milliseconds >*/
+#define TRANSITION_DURATION_MAX_MS	10000U
+
+/**< @brief Outgoing pattern being faded out >*/
+struct transition {
+	/* NULL when no transition is running */
+	const struct pattern_descriptor *from;
+	/* Color the outgoing pattern was rendered with */
+	uint32_t color;
+	/* Seconds in Q16.16, as frame_context time */
+	uint32_t elapsed;
+	uint32_t duration;
+	/* Weight of the incoming pattern in the current frame, out of 256 */
+	uint32_t weight;
+	/* Time spent blending during the last frame and its maximum */
+	uint32_t blend_us;
+	uint32_t blend_us_max;
+	uint32_t blend_cycles;
+};
+
+/**
+ * @brief Start fading from a pattern to the currently selected one
+ * @details A transition already running is dropped, its outgoing pattern
+ *          is released unless it is @p from or @p to.
+ *
+ * @param[inout] transition: transition state
+ * @param[in] from: outgoing pattern, released with deinit at the end
+ * @param[in] to: incoming pattern
+ * @param[in] color: color of the outgoing pattern
+ * @param[in] duration_ms: fade duration, 0 switches at once
+ */
+void transition_start(struct transition *transition, const struct pattern_descriptor *from,
+		      const struct pattern_descriptor *to, uint32_t color, uint32_t duration_ms);
+
+/**
+ * @brief Tell whether a transition is running
+ *
+ * @param[in] transition: transition state
+ * @return true while the outgoing pattern is still rendered
+ */
+static inline bool transition_active(const struct transition *transition)
+{
+	return transition->from != NULL;
+}
+
+/**
+ * @brief Move the running transition and both patterns to the next frame
+ * @details The transition ends, and the outgoing pattern is released, once
+ *          ctx->delta added up to the duration; only the incoming pattern
+ *          is advanced then, as it is without a running transition.
+ *
+ * @param[inout] transition: transition state
+ * @param[in] to: incoming pattern
+ * @param[in] ctx: frame context of the incoming pattern
+ */
+void transition_advance(struct transition *transition, const struct pattern_descriptor *to,
+			const struct frame_context *ctx);
+
+/**
+ * @brief Render a span of the frame prepared by transition_advance()
+ * @details The outgoing pattern is rendered in @p pixel_array, the incoming
+ *          one is rendered tile by tile in a CONFIG_APP_LED_PLAYER_TILE_PIXELS
+ *          buffer and blended in place, so a transition costs one tile of
+ *          memory, not a second frame. Without a running transition the
+ *          incoming pattern is rendered alone.
+ *
+ * @param[inout] transition: transition state
+ * @param[in] to: incoming pattern
+ * @param[out] pixel_array: ctx->count pixels of the span
+ * @param[in] ctx: frame context of the incoming pattern, span start and count
+ */
+void transition_render_span(struct transition *transition, const struct pattern_descriptor *to,
+			    struct led_rgb *pixel_array, const struct frame_context *ctx);
+
+/**
+ * @brief Tell whether the frame can be rendered with transition_render_span16()
+ *
+ * @param[in] transition: transition state
+ * @param[in] to: incoming pattern
+ * @return true if every pattern of the frame renders at 16 bits
+ */
+bool transition_has_process16(const struct transition *transition,
+			      const struct pattern_descriptor *to);
+
+/**
+ * @brief 16-bit version of transition_render_span()
+ * @details Both patterns must have process16, see transition_has_process16().
+ *
+ * @param[inout] transition: transition state
+ * @param[in] to: incoming pattern
+ * @param[out] pixels: ctx->count pixels of the span, Q8.8
+ * @param[in] ctx: frame context of the incoming pattern, span start and count
+ */
+void transition_render_span16(struct transition *transition, const struct pattern_descriptor *to,
+			      struct pattern_rgb16 *pixels, const struct frame_context *ctx);
+
+#endif /* TRANSITION_H */
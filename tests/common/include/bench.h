@@ -0,0 +1,25 @@
+/*
+ * Copyright (c) 2024 Romain Pelletant
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <zephyr/kernel.h>
+
+/*
+ * Host clock for the benchmarks. On native_sim the simulated time stands
+ * still while code runs, so k_cycle_get_32() cannot time it. Needs
+ * CONFIG_EXTERNAL_LIBC. Results are printed, not asserted: they depend on
+ * the host.
+ */
+
+/**
+ * @brief Read the host monotonic clock
+ *
+ * @return uint64_t time in ns
+ */
+uint64_t bench_now_ns(void);
+
+#endif /* BENCH_H */
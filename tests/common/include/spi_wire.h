@@ -0,0 +1,58 @@
+/*
+ * Copyright (c) 2024 Romain Pelletant
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#ifndef SPI_WIRE_H
+#define SPI_WIRE_H
+
+#include <zephyr/device.h>
+
+/*
+ * Emulated SPI controller. An asynchronous transfer holds the bus for the
+ * time its bytes take on the wire at the requested clock, then completes
+ * from the timer interrupt. Between two transfers of one frame the data
+ * line is low: a transfer started after the latch time would have shown a
+ * partial frame on a real strip.
+ */
+
+/**< @brief What the wire saw since spi_wire_start() >*/
+struct spi_wire_stats {
+	/* Transfers started */
+	uint32_t chunks;
+	/* Transfers started after the line latched */
+	uint32_t late_chunks;
+	/* Longest low time between two transfers of a frame, in us */
+	uint32_t max_gap_us;
+	/* Bytes sent, including the ones that did not fit the capture */
+	size_t frame_len;
+};
+
+/**
+ * @brief Clear the statistics and capture the next frame
+ *
+ * @param[in] dev: emulated controller
+ * @param[in] latch_us: low time that latches the strip
+ * @param[out] capture: bytes sent, in order
+ * @param[in] size: size of capture
+ */
+void spi_wire_start(const struct device *dev, uint32_t latch_us, uint8_t *capture, size_t size);
+
+/**
+ * @brief Get what the wire saw since spi_wire_start()
+ *
+ * @param[in] dev: emulated controller
+ * @param[out] stats: statistics
+ */
+void spi_wire_stats_get(const struct device *dev, struct spi_wire_stats *stats);
+
+/**
+ * @brief Make the next transfers fail, until spi_wire_start()
+ *
+ * @param[in] dev: emulated controller
+ * @param[in] start_err: negative errno a transfer is refused with, nothing is sent, 0 for none
+ * @param[in] end_err: negative errno a transfer completes with once sent, 0 for none
+ */
+void spi_wire_fail(const struct device *dev, int start_err, int end_err);
+
+#endif /* SPI_WIRE_H */
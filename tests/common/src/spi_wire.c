@@ -0,0 +1,206 @@
+/*
+ * Copyright (c) 2024 Romain Pelletant
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#define DT_DRV_COMPAT test_spi_wire
+
+#include <zephyr/kernel.h>
+#include <zephyr/drivers/spi.h>
+#include <string.h>
+
+#include "spi_wire.h"
+
+/////////////////////////////////////
+// Local variables declarations
+/////////////////////////////////////
+
+/**< @brief Controller state >*/
+struct spi_wire_data {
+	const struct device *dev;
+	/* Expires when the last byte left the wire */
+	struct k_timer wire;
+	spi_callback_t cb;
+	void *userdata;
+	/* Uptime in ticks when the line went low */
+	int64_t idle_since;
+	/* A frame is on the wire until the bus is released */
+	bool frame_open;
+	uint32_t latch_us;
+	uint8_t *capture;
+	size_t size;
+	struct spi_wire_stats stats;
+	/* Injected failures, see spi_wire_fail() */
+	int start_err;
+	int end_err;
+};
+
+/////////////////////////////////////
+// Local function declarations
+/////////////////////////////////////
+
+/**
+ * @brief Append the transmit buffers to the capture
+ *
+ * @return size_t bytes sent
+ */
+static size_t spi_wire_record(struct spi_wire_data *data, const struct spi_buf_set *tx_bufs);
+
+/**
+ * @brief Timer expiry: the transfer is over and the line goes low
+ */
+static void spi_wire_idle(struct k_timer *timer);
+
+/////////////////////////////////////
+// Local functions definition
+/////////////////////////////////////
+
+static size_t spi_wire_record(struct spi_wire_data *data, const struct spi_buf_set *tx_bufs)
+{
+	size_t sent = 0;
+
+	for (size_t i = 0; tx_bufs != NULL && i < tx_bufs->count; i++) {
+		const struct spi_buf *buf = &tx_bufs->buffers[i];
+		const size_t offset = data->stats.frame_len + sent;
+
+		if (buf->buf != NULL && offset < data->size) {
+			memcpy(&data->capture[offset], buf->buf, MIN(buf->len, data->size - offset));
+		}
+		sent += buf->len;
+	}
+
+	data->stats.frame_len += sent;
+
+	return sent;
+}
+
+static void spi_wire_idle(struct k_timer *timer)
+{
+	struct spi_wire_data *data = CONTAINER_OF(timer, struct spi_wire_data, wire);
+
+	data->idle_since = k_uptime_ticks();
+	data->cb(data->dev, data->end_err, data->userdata);
+}
+
+static int spi_wire_transceive(const struct device *dev, const struct spi_config *config,
+			       const struct spi_buf_set *tx_bufs,
+			       const struct spi_buf_set *rx_bufs)
+{
+	struct spi_wire_data *data = dev->data;
+
+	ARG_UNUSED(config);
+	ARG_UNUSED(rx_bufs);
+
+	if (data->start_err) {
+		return data->start_err;
+	}
+
+	(void)spi_wire_record(data, tx_bufs);
+
+	return data->end_err;
+}
+
+static int spi_wire_transceive_async(const struct device *dev, const struct spi_config *config,
+				     const struct spi_buf_set *tx_bufs,
+				     const struct spi_buf_set *rx_bufs, spi_callback_t cb,
+				     void *userdata)
+{
+	struct spi_wire_data *data = dev->data;
+	size_t sent;
+
+	ARG_UNUSED(rx_bufs);
+
+	if (cb == NULL || config->frequency == 0) {
+		return -ENOTSUP;
+	}
+
+	if (data->start_err) {
+		return data->start_err;
+	}
+
+	if (data->frame_open) {
+		const uint32_t gap_us = k_ticks_to_us_floor32(k_uptime_ticks() - data->idle_since);
+
+		data->stats.max_gap_us = MAX(data->stats.max_gap_us, gap_us);
+		if (gap_us >= data->latch_us) {
+			data->stats.late_chunks++;
+		}
+	}
+
+	sent = spi_wire_record(data, tx_bufs);
+	data->stats.chunks++;
+	data->frame_open = true;
+	data->cb = cb;
+	data->userdata = userdata;
+
+	k_timer_start(&data->wire,
+		      K_USEC(DIV_ROUND_UP(sent * 8ULL * USEC_PER_SEC, config->frequency)),
+		      K_NO_WAIT);
+
+	return 0;
+}
+
+static int spi_wire_release(const struct device *dev, const struct spi_config *config)
+{
+	struct spi_wire_data *data = dev->data;
+
+	ARG_UNUSED(config);
+
+	data->frame_open = false;
+
+	return 0;
+}
+
+static int spi_wire_init(const struct device *dev)
+{
+	struct spi_wire_data *data = dev->data;
+
+	data->dev = dev;
+	k_timer_init(&data->wire, spi_wire_idle, NULL);
+
+	return 0;
+}
+
+static DEVICE_API(spi, spi_wire_api) = {
+	.transceive = spi_wire_transceive,
+	.transceive_async = spi_wire_transceive_async,
+	.release = spi_wire_release,
+};
+
+/////////////////////////////////////
+// Functions definition
+/////////////////////////////////////
+
+void spi_wire_start(const struct device *dev, uint32_t latch_us, uint8_t *capture, size_t size)
+{
+	struct spi_wire_data *data = dev->data;
+
+	data->latch_us = latch_us;
+	data->capture = capture;
+	data->size = size;
+	data->frame_open = false;
+	data->start_err = 0;
+	data->end_err = 0;
+	memset(&data->stats, 0, sizeof(data->stats));
+	memset(capture, 0, size);
+}
+
+void spi_wire_fail(const struct device *dev, int start_err, int end_err)
+{
+	struct spi_wire_data *data = dev->data;
+
+	data->start_err = start_err;
+	data->end_err = end_err;
+}
+
+void spi_wire_stats_get(const struct device *dev, struct spi_wire_stats *stats)
+{
+	*stats = ((struct spi_wire_data *)dev->data)->stats;
+}
+
+#define SPI_WIRE_DEFINE(idx)								\
+	static struct spi_wire_data spi_wire_data_##idx;				\
+	DEVICE_DT_INST_DEFINE(idx, spi_wire_init, NULL, &spi_wire_data_##idx, NULL,	\
+			      POST_KERNEL, CONFIG_SPI_INIT_PRIORITY, &spi_wire_api);
+
+DT_INST_FOREACH_STATUS_OKAY(SPI_WIRE_DEFINE)
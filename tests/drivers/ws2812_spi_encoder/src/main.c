@@ -0,0 +1,586 @@
+/*
+ * Copyright (c) 2024 Romain Pelletant
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#include <zephyr/kernel.h>
+#include <zephyr/ztest.h>
+#include <zephyr/drivers/led_strip.h>
+#include <zephyr/dt-bindings/led/led.h>
+#include <string.h>
+
+#include <led_player/backend/ws2812_timing.h>
+
+#include <bench.h>
+#include <spi_wire.h>
+
+#define STRIP_LENGTH		16U
+/* Two tiles of the compact format expansion and part of a third */
+#define LONG_LENGTH		37U
+#define COLORS_MAX		4U
+/* Largest frame of the overlay: 8-bit frames, or four channels */
+#define CAPTURE_SIZE		(LONG_LENGTH * COLORS_MAX * 8U)
+#define LATCH_US		280U
+
+#define BENCH_PIXELS_MAX	10000U
+/* Pixels encoded per measure, whatever the strip length */
+#define BENCH_TOTAL_PIXELS	2000000U
+
+/* Same checks on both encoders, see testcase.yaml */
+#define ENCODER_NAME		(IS_ENABLED(CONFIG_WS2812_STRIP_SPI_SPECIALIZED_ENCODERS) ?	\
+				 "specialized" : "generic")
+
+/**< @brief A strip of the overlay and what its frames look like >*/
+struct test_strip {
+	const struct device *dev;
+	const uint8_t *mapping;
+	uint8_t num_colors;
+	uint8_t one_frame;
+	uint8_t zero_frame;
+};
+
+#define TEST_STRIP(_node)							\
+	{									\
+		.dev = DEVICE_DT_GET(_node),					\
+		.mapping = (const uint8_t[])DT_PROP(_node, color_mapping),	\
+		.num_colors = DT_PROP_LEN(_node, color_mapping),		\
+		.one_frame = DT_PROP(_node, spi_one_frame),			\
+		.zero_frame = DT_PROP(_node, spi_zero_frame),			\
+	}
+
+static const struct test_strip strips[] = {
+	TEST_STRIP(DT_NODELABEL(strip_8bit)),
+	TEST_STRIP(DT_NODELABEL(strip_4bit)),
+	TEST_STRIP(DT_NODELABEL(strip_3bit)),
+};
+
+static const struct device *const wire = DEVICE_DT_GET(DT_NODELABEL(spi_wire));
+
+static struct led_rgb pixels[BENCH_PIXELS_MAX];
+static uint8_t capture[CAPTURE_SIZE];
+static uint8_t expected[CAPTURE_SIZE];
+/* Frame of the 8-bit strip as the per-bit loop encoded it */
+static uint8_t old_buf[BENCH_PIXELS_MAX * 3U * 8U];
+static uint8_t indices[LONG_LENGTH];
+static uint16_t rgb565[LONG_LENGTH];
+static struct led_rgb palette[LED_STRIP_PALETTE_SIZE];
+
+static K_SEM_DEFINE(flushed, 0, 1);
+static int flush_result;
+
+/* Frame width the driver picks from the frames */
+static uint8_t frame_bits_of(const struct test_strip *strip)
+{
+	const uint8_t frames = strip->one_frame | strip->zero_frame;
+
+	return frames < BIT(3) ? 3U : frames < BIT(4) ? 4U : 8U;
+}
+
+static void fill_pixels(size_t count, uint32_t seed)
+{
+	for (size_t i = 0; i < count; i++) {
+		pixels[i].r = (uint8_t)(i * 7U + seed);
+		pixels[i].g = (uint8_t)(i * 13U + seed * 3U);
+		pixels[i].b = (uint8_t)(i * 29U + seed * 5U);
+	}
+}
+
+/* Reference bitstream, one bit at a time, the white channel off */
+static size_t encode_expected(const struct test_strip *strip, size_t count)
+{
+	static uint8_t bytes[LONG_LENGTH * COLORS_MAX];
+	const struct ws2812_encoding enc = {
+		.frame_bits = frame_bits_of(strip),
+		.one_frame = strip->one_frame,
+		.zero_frame = strip->zero_frame,
+	};
+	size_t len = 0U;
+
+	for (size_t i = 0; i < count; i++) {
+		for (size_t j = 0; j < strip->num_colors; j++) {
+			switch (strip->mapping[j]) {
+			case LED_COLOR_ID_RED:
+				bytes[len++] = pixels[i].r;
+				break;
+			case LED_COLOR_ID_GREEN:
+				bytes[len++] = pixels[i].g;
+				break;
+			case LED_COLOR_ID_BLUE:
+				bytes[len++] = pixels[i].b;
+				break;
+			default:
+				bytes[len++] = 0U;
+				break;
+			}
+		}
+	}
+
+	ws2812_timing_encode(&enc, bytes, len, expected);
+
+	return len * enc.frame_bits;
+}
+
+/* Encoder the driver used before the nibble table, 8-bit frames only */
+static void old_encode(const struct test_strip *strip, uint8_t *buf, size_t count)
+{
+	for (size_t i = 0; i < count; i++) {
+		for (size_t j = 0; j < strip->num_colors; j++) {
+			uint8_t value;
+
+			switch (strip->mapping[j]) {
+			case LED_COLOR_ID_RED:
+				value = pixels[i].r;
+				break;
+			case LED_COLOR_ID_GREEN:
+				value = pixels[i].g;
+				break;
+			case LED_COLOR_ID_BLUE:
+				value = pixels[i].b;
+				break;
+			default:
+				value = 0U;
+				break;
+			}
+
+			for (int bit = 0; bit < 8; bit++) {
+				buf[bit] = value & BIT(7 - bit) ? strip->one_frame : strip->zero_frame;
+			}
+			buf += 8;
+		}
+	}
+}
+
+static void flush_done(const struct device *dev, int result, void *user_data)
+{
+	ARG_UNUSED(dev);
+	ARG_UNUSED(user_data);
+
+	flush_result = result;
+	k_sem_give(&flushed);
+}
+
+/* Wait for the frame started with flush_done, check it against the first len bytes of expected */
+static void check_sent(const struct test_strip *strip, size_t len)
+{
+	struct spi_wire_stats stats;
+
+	zassert_ok(k_sem_take(&flushed, K_SECONDS(1)));
+	zassert_ok(flush_result);
+	spi_wire_stats_get(wire, &stats);
+
+	zassert_equal(stats.frame_len, len, "%s: %zu bytes sent", strip->dev->name,
+		      stats.frame_len);
+	zassert_mem_equal(capture, expected, len, "%s", strip->dev->name);
+}
+
+/* Send the frame encoded by spans and check it */
+static void flush_and_check(const struct test_strip *strip, size_t len)
+{
+	spi_wire_start(wire, LATCH_US, capture, sizeof(capture));
+	zassert_ok(led_strip_flush_async(strip->dev, flush_done, NULL));
+	check_sent(strip, len);
+}
+
+static void *ws2812_spi_encoder_setup(void)
+{
+	zassert_true(device_is_ready(wire));
+	for (size_t s = 0; s < ARRAY_SIZE(strips); s++) {
+		zassert_true(device_is_ready(strips[s].dev), "%s", strips[s].dev->name);
+	}
+
+	return NULL;
+}
+
+static void ws2812_spi_encoder_after(void *fixture)
+{
+	ARG_UNUSED(fixture);
+
+	/* Cases which resize a strip may stop halfway */
+	for (size_t s = 0; s < ARRAY_SIZE(strips); s++) {
+		(void)led_strip_set_length(strips[s].dev, STRIP_LENGTH);
+	}
+}
+
+ZTEST(ws2812_spi_encoder, test_update_matches_reference)
+{
+	struct spi_wire_stats stats;
+
+	for (size_t s = 0; s < ARRAY_SIZE(strips); s++) {
+		const struct test_strip *strip = &strips[s];
+
+		for (uint32_t seed = 0; seed < 8U; seed++) {
+			size_t len;
+
+			fill_pixels(STRIP_LENGTH, seed);
+			len = encode_expected(strip, STRIP_LENGTH);
+
+			spi_wire_start(wire, LATCH_US, capture, sizeof(capture));
+			zassert_ok(led_strip_update_rgb(strip->dev, pixels, STRIP_LENGTH));
+			spi_wire_stats_get(wire, &stats);
+
+			zassert_equal(stats.frame_len, len, "%s: %zu bytes sent", strip->dev->name,
+				      stats.frame_len);
+			zassert_mem_equal(capture, expected, len, "%s: seed %u", strip->dev->name,
+					  seed);
+		}
+	}
+}
+
+ZTEST(ws2812_spi_encoder, test_spans_match_reference)
+{
+	/* Spans of every small size, so that each lands at many offsets */
+	static const size_t spans[] = { 1U, 2U, 3U, 1U, 4U, 5U };
+
+	for (size_t s = 0; s < ARRAY_SIZE(strips); s++) {
+		const struct test_strip *strip = &strips[s];
+		size_t offset = 0U;
+		size_t len;
+
+		fill_pixels(STRIP_LENGTH, 42U + s);
+		len = encode_expected(strip, STRIP_LENGTH);
+
+		for (size_t i = 0; offset < STRIP_LENGTH; i++) {
+			const size_t count = MIN(spans[i % ARRAY_SIZE(spans)], STRIP_LENGTH - offset);
+
+			zassert_ok(led_strip_encode_span(strip->dev, offset, &pixels[offset], count));
+			offset += count;
+		}
+
+		flush_and_check(strip, len);
+	}
+}
+
+ZTEST(ws2812_spi_encoder, test_span_format_index8_matches_rgb)
+{
+	/* One pixel, then spans across the tiles the driver expands */
+	static const size_t spans[] = { 1U, 17U, LONG_LENGTH - 18U };
+
+	for (size_t i = 0; i < ARRAY_SIZE(palette); i++) {
+		palette[i].r = (uint8_t)(i * 37U + 1U);
+		palette[i].g = (uint8_t)(255U - i);
+		palette[i].b = (uint8_t)(i ^ 0x5aU);
+	}
+
+	for (size_t s = 0; s < ARRAY_SIZE(strips); s++) {
+		const struct test_strip *strip = &strips[s];
+		size_t offset = 0U;
+
+		zassert_ok(led_strip_set_length(strip->dev, LONG_LENGTH));
+
+		/* Indices 0 and 255 on the first pixel of the first two strips */
+		for (size_t i = 0; i < LONG_LENGTH; i++) {
+			indices[i] = (uint8_t)(i * 53U + s * 255U);
+			pixels[i] = palette[indices[i]];
+		}
+
+		for (size_t i = 0; i < ARRAY_SIZE(spans); i++) {
+			zassert_ok(led_strip_encode_span_format(strip->dev, offset,
+								LED_STRIP_FORMAT_INDEX8,
+								&indices[offset], spans[i],
+								palette));
+			offset += spans[i];
+		}
+
+		flush_and_check(strip, encode_expected(strip, LONG_LENGTH));
+	}
+}
+
+ZTEST(ws2812_spi_encoder, test_span_format_rgb565_matches_rgb)
+{
+	static const size_t spans[] = { LONG_LENGTH - 20U, 19U, 1U };
+
+	for (size_t s = 0; s < ARRAY_SIZE(strips); s++) {
+		const struct test_strip *strip = &strips[s];
+		size_t offset = 0U;
+
+		zassert_ok(led_strip_set_length(strip->dev, LONG_LENGTH));
+
+		for (size_t i = 0; i < LONG_LENGTH; i++) {
+			/* Black and white at both ends, so the replicated bits are seen */
+			const uint16_t value = i == 0U ? 0x0000U :
+					       i == LONG_LENGTH - 1U ? 0xffffU :
+					       (uint16_t)(i * 2897U + s * 611U);
+			const uint8_t r = value >> 11;
+			const uint8_t g = (value >> 5) & 0x3fU;
+			const uint8_t b = value & 0x1fU;
+
+			rgb565[i] = value;
+			pixels[i].r = (r << 3) | (r >> 2);
+			pixels[i].g = (g << 2) | (g >> 4);
+			pixels[i].b = (b << 3) | (b >> 2);
+		}
+
+		for (size_t i = 0; i < ARRAY_SIZE(spans); i++) {
+			zassert_ok(led_strip_encode_span_format(strip->dev, offset,
+								LED_STRIP_FORMAT_RGB565,
+								&rgb565[offset], spans[i], NULL));
+			offset += spans[i];
+		}
+
+		flush_and_check(strip, encode_expected(strip, LONG_LENGTH));
+	}
+}
+
+ZTEST(ws2812_spi_encoder, test_span_format_rgb_is_encode_span)
+{
+	for (size_t s = 0; s < ARRAY_SIZE(strips); s++) {
+		const struct test_strip *strip = &strips[s];
+
+		fill_pixels(STRIP_LENGTH, 11U + s);
+
+		/* The palette is ignored */
+		zassert_ok(led_strip_encode_span_format(strip->dev, 0U, LED_STRIP_FORMAT_RGB,
+							pixels, 5U, NULL));
+		zassert_ok(led_strip_encode_span_format(strip->dev, 5U, LED_STRIP_FORMAT_RGB,
+							&pixels[5], STRIP_LENGTH - 5U, palette));
+
+		flush_and_check(strip, encode_expected(strip, STRIP_LENGTH));
+	}
+}
+
+ZTEST(ws2812_spi_encoder, test_span_format_errors)
+{
+	const struct device *dev = strips[0].dev;
+
+	zassert_equal(led_strip_encode_span_format(dev, 0U, LED_STRIP_FORMAT_INDEX8, indices,
+						   STRIP_LENGTH, NULL), -EINVAL);
+	zassert_equal(led_strip_encode_span_format(dev, 0U, (enum led_strip_format)3, rgb565,
+						   STRIP_LENGTH, palette), -ENOTSUP);
+
+	for (size_t f = LED_STRIP_FORMAT_RGB; f <= LED_STRIP_FORMAT_INDEX8; f++) {
+		const enum led_strip_format format = f;
+		const void *span = format == LED_STRIP_FORMAT_RGB ? (const void *)pixels :
+				   format == LED_STRIP_FORMAT_RGB565 ? (const void *)rgb565 :
+				   (const void *)indices;
+
+		zassert_equal(led_strip_encode_span_format(dev, 0U, format, span,
+							   STRIP_LENGTH + 1U, palette),
+			      -ERANGE, "format %zu", f);
+		zassert_equal(led_strip_encode_span_format(dev, STRIP_LENGTH - 1U, format, span,
+							   2U, palette),
+			      -ERANGE, "format %zu", f);
+		zassert_equal(led_strip_encode_span_format(dev, STRIP_LENGTH + 1U, format, span,
+							   0U, palette),
+			      -ERANGE, "format %zu", f);
+		/* Up to the end is fine */
+		zassert_ok(led_strip_encode_span_format(dev, STRIP_LENGTH - 1U, format, span, 1U,
+							palette),
+			   "format %zu", f);
+	}
+}
+
+ZTEST(ws2812_spi_encoder, test_runs_match_pixels)
+{
+	/* Zero-length runs anywhere, runs of odd lengths that end the doubling copy midway */
+	static const size_t lengths[][6] = {
+		{ LONG_LENGTH },
+		{ 0U, 1U, 7U, 0U, 12U, 5U },
+		{ 3U, 0U, 0U, 13U, 1U, 0U },
+	};
+	static const size_t offsets[] = { 0U, 2U, 9U };
+	struct led_strip_run runs[ARRAY_SIZE(lengths[0])];
+
+	for (size_t s = 0; s < ARRAY_SIZE(strips); s++) {
+		const struct test_strip *strip = &strips[s];
+
+		zassert_ok(led_strip_set_length(strip->dev, LONG_LENGTH));
+
+		for (size_t r = 0; r < ARRAY_SIZE(lengths); r++) {
+			size_t offset = offsets[r];
+
+			/* Pixels outside of the runs keep what was encoded before */
+			fill_pixels(LONG_LENGTH, r + s);
+			zassert_ok(led_strip_encode_span(strip->dev, 0U, pixels, LONG_LENGTH));
+
+			for (size_t i = 0; i < ARRAY_SIZE(runs); i++) {
+				runs[i].length = lengths[r][i];
+				runs[i].color.r = (uint8_t)(0x11U * i + r);
+				runs[i].color.g = (uint8_t)(0xf0U - 0x23U * i);
+				runs[i].color.b = (uint8_t)(0x5aU ^ (i << 4));
+
+				for (size_t j = 0; j < runs[i].length; j++) {
+					pixels[offset++] = runs[i].color;
+				}
+			}
+			zassert_true(offset <= LONG_LENGTH);
+
+			zassert_ok(led_strip_encode_runs(strip->dev, offsets[r], runs,
+							 ARRAY_SIZE(runs)));
+			flush_and_check(strip, encode_expected(strip, LONG_LENGTH));
+		}
+	}
+}
+
+ZTEST(ws2812_spi_encoder, test_runs_errors)
+{
+	const struct device *dev = strips[0].dev;
+	struct led_strip_run runs[] = {
+		{ .length = STRIP_LENGTH / 2U },
+		{ .length = 0U },
+		{ .length = STRIP_LENGTH / 2U },
+	};
+
+	zassert_ok(led_strip_encode_runs(dev, 0U, runs, ARRAY_SIZE(runs)));
+	zassert_ok(led_strip_encode_runs(dev, STRIP_LENGTH, runs, 0U));
+	zassert_ok(led_strip_encode_runs(dev, STRIP_LENGTH, &runs[1], 1U));
+
+	zassert_equal(led_strip_encode_runs(dev, 1U, runs, ARRAY_SIZE(runs)), -ERANGE);
+	zassert_equal(led_strip_encode_runs(dev, STRIP_LENGTH + 1U, runs, 0U), -ERANGE);
+
+	/* Lengths which would wrap around when added up */
+	runs[1].length = SIZE_MAX;
+	zassert_equal(led_strip_encode_runs(dev, 0U, runs, ARRAY_SIZE(runs)), -ERANGE);
+}
+
+ZTEST(ws2812_spi_encoder, test_flush_prefix_sends_head)
+{
+	static const size_t heads[] = { 1U, 5U, STRIP_LENGTH - 1U, STRIP_LENGTH };
+	struct spi_wire_stats stats;
+
+	for (size_t s = 0; s < ARRAY_SIZE(strips); s++) {
+		const struct test_strip *strip = &strips[s];
+
+		for (size_t h = 0; h < ARRAY_SIZE(heads); h++) {
+			const size_t head = heads[h];
+
+			/* Only the head is encoded, whatever the back buffer held */
+			fill_pixels(STRIP_LENGTH, head + s);
+			zassert_ok(led_strip_encode_span(strip->dev, 0U, pixels, head));
+
+			spi_wire_start(wire, LATCH_US, capture, sizeof(capture));
+			zassert_ok(led_strip_flush_prefix_async(strip->dev, head, flush_done,
+								NULL));
+			/* Exactly head pixels, then the latch before the callback */
+			check_sent(strip, encode_expected(strip, head));
+			spi_wire_stats_get(wire, &stats);
+			zassert_equal(stats.chunks, 1U, "%s: head %zu", strip->dev->name, head);
+			zassert_equal(stats.late_chunks, 0U, "%s: head %zu", strip->dev->name,
+				      head);
+		}
+	}
+}
+
+ZTEST(ws2812_spi_encoder, test_flush_prefix_errors)
+{
+	const struct device *dev = strips[0].dev;
+	struct spi_wire_stats stats;
+
+	spi_wire_start(wire, LATCH_US, capture, sizeof(capture));
+	zassert_equal(led_strip_flush_prefix_async(dev, 0U, flush_done, NULL), -ERANGE);
+	zassert_equal(led_strip_flush_prefix_async(dev, STRIP_LENGTH + 1U, flush_done, NULL),
+		      -ERANGE);
+
+	/* Nothing sent, no callback */
+	spi_wire_stats_get(wire, &stats);
+	zassert_equal(stats.chunks, 0U);
+	zassert_equal(k_sem_take(&flushed, K_NO_WAIT), -EBUSY);
+}
+
+ZTEST(ws2812_spi_encoder, test_rotate_matches_reencoded)
+{
+	struct led_rgb frame[STRIP_LENGTH];
+
+	for (size_t s = 0; s < ARRAY_SIZE(strips); s++) {
+		const struct test_strip *strip = &strips[s];
+
+		fill_pixels(STRIP_LENGTH, 5U + s);
+		memcpy(frame, pixels, sizeof(frame));
+		zassert_ok(led_strip_encode_span(strip->dev, 0U, frame, STRIP_LENGTH));
+		flush_and_check(strip, encode_expected(strip, STRIP_LENGTH));
+
+		for (size_t offset = 0; offset < STRIP_LENGTH; offset++) {
+			size_t len;
+
+			for (size_t i = 0; i < STRIP_LENGTH; i++) {
+				pixels[i] = frame[(i + offset) % STRIP_LENGTH];
+			}
+			len = encode_expected(strip, STRIP_LENGTH);
+
+			/* Spans of the next frame do not show in the rotated one */
+			zassert_ok(led_strip_encode_span(strip->dev, 0U, &frame[1], 3U));
+
+			spi_wire_start(wire, LATCH_US, capture, sizeof(capture));
+			zassert_ok(led_strip_rotate_async(strip->dev, offset, flush_done, NULL));
+			check_sent(strip, len);
+		}
+	}
+}
+
+ZTEST(ws2812_spi_encoder, test_rotate_errors)
+{
+	const struct test_strip *strip = &strips[0];
+
+	/* Nothing sent since the strip was last resized */
+	zassert_equal(led_strip_rotate_async(strip->dev, 0U, NULL, NULL), -ENODATA);
+
+	fill_pixels(STRIP_LENGTH, 3U);
+	zassert_ok(led_strip_encode_span(strip->dev, 0U, pixels, STRIP_LENGTH));
+	flush_and_check(strip, encode_expected(strip, STRIP_LENGTH));
+
+	zassert_equal(led_strip_rotate_async(strip->dev, STRIP_LENGTH, NULL, NULL), -ERANGE);
+	zassert_equal(led_strip_rotate_async(strip->dev, SIZE_MAX, NULL, NULL), -ERANGE);
+
+	/* A prefix leaves the rest of the frame unsent: there is nothing to rotate */
+	zassert_ok(led_strip_encode_span(strip->dev, 0U, pixels, STRIP_LENGTH));
+	spi_wire_start(wire, LATCH_US, capture, sizeof(capture));
+	zassert_ok(led_strip_flush_prefix_async(strip->dev, STRIP_LENGTH / 2U, flush_done, NULL));
+	zassert_ok(k_sem_take(&flushed, K_SECONDS(1)));
+	zassert_equal(led_strip_rotate_async(strip->dev, 1U, NULL, NULL), -ENODATA);
+
+	/* Until a whole frame is sent again */
+	zassert_ok(led_strip_encode_span(strip->dev, 0U, pixels, STRIP_LENGTH));
+	flush_and_check(strip, encode_expected(strip, STRIP_LENGTH));
+	spi_wire_start(wire, LATCH_US, capture, sizeof(capture));
+	zassert_ok(led_strip_rotate_async(strip->dev, 0U, flush_done, NULL));
+	check_sent(strip, encode_expected(strip, STRIP_LENGTH));
+
+	/* Resizing drops the frame */
+	zassert_ok(led_strip_set_length(strip->dev, STRIP_LENGTH));
+	zassert_equal(led_strip_rotate_async(strip->dev, 0U, NULL, NULL), -ENODATA);
+}
+
+ZTEST(ws2812_spi_encoder, test_benchmark)
+{
+	static const size_t lengths[] = { 14U, 1000U, BENCH_PIXELS_MAX };
+	const struct test_strip *strip_8bit = &strips[0];
+
+	fill_pixels(BENCH_PIXELS_MAX, 7U);
+
+	for (size_t l = 0; l < ARRAY_SIZE(lengths); l++) {
+		const size_t length = lengths[l];
+		const uint32_t rounds = BENCH_TOTAL_PIXELS / length;
+		uint64_t begin;
+		uint64_t old_ns;
+
+		begin = bench_now_ns();
+		for (uint32_t round = 0; round < rounds; round++) {
+			old_encode(strip_8bit, old_buf, length);
+			compiler_barrier();
+		}
+		old_ns = bench_now_ns() - begin;
+		TC_PRINT("%5zu LEDs, per LED: per-bit loop %llu ps\n", length,
+			 (unsigned long long)(old_ns * 1000U / (rounds * length)));
+
+		for (size_t s = 0; s < ARRAY_SIZE(strips); s++) {
+			const struct test_strip *strip = &strips[s];
+			uint64_t ns;
+
+			zassert_ok(led_strip_set_length(strip->dev, length));
+
+			begin = bench_now_ns();
+			for (uint32_t round = 0; round < rounds; round++) {
+				zassert_ok(led_strip_encode_span(strip->dev, 0U, pixels, length));
+			}
+			ns = bench_now_ns() - begin;
+
+			TC_PRINT("%5zu LEDs, per LED: %s %u-bit frames %u channels %llu ps\n",
+				 length, ENCODER_NAME, frame_bits_of(strip), strip->num_colors,
+				 (unsigned long long)(ns * 1000U / (rounds * length)));
+
+			zassert_ok(led_strip_set_length(strip->dev, STRIP_LENGTH));
+		}
+	}
+}
+
+ZTEST_SUITE(ws2812_spi_encoder, NULL, ws2812_spi_encoder_setup, NULL,
+	    ws2812_spi_encoder_after, NULL);
@@ -0,0 +1,170 @@
+/*
+ * Copyright (c) 2024 Romain Pelletant
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#include <zephyr/kernel.h>
+#include <zephyr/ztest.h>
+#include <zephyr/drivers/led_strip.h>
+#include <string.h>
+
+#include <led_player/backend/ws2812_timing.h>
+
+#include "spi_wire.h"
+
+#define STRIP_NODE		DT_ALIAS(led_strip)
+#define STRIP_LENGTH		DT_PROP(STRIP_NODE, chain_length)
+#define STRIP_COLORS		DT_PROP_LEN(STRIP_NODE, color_mapping)
+/* 3-bit frames: three SPI bytes per channel byte */
+#define FRAME_BITS		3U
+#define FRAME_LEN		(STRIP_LENGTH * STRIP_COLORS * FRAME_BITS)
+/* Line held low this long latches a WS2812B */
+#define LATCH_US		280U
+
+#define RENDER_PRIORITY		5
+/* Preempts the render thread while the bus runs */
+#define HOG_PRIORITY		2
+#define HOG_DELAY_US		300U
+#define HOG_US			2000U
+#define STACK_SIZE		2048
+
+static const struct device *const strip = DEVICE_DT_GET(STRIP_NODE);
+static const struct device *const wire = DEVICE_DT_GET(DT_PARENT(STRIP_NODE));
+
+static struct led_rgb pixels[STRIP_LENGTH];
+static uint8_t capture[FRAME_LEN + 64];
+static uint8_t expected[FRAME_LEN];
+static int render_rc;
+
+K_THREAD_STACK_DEFINE(render_stack, STACK_SIZE);
+K_THREAD_STACK_DEFINE(hog_stack, STACK_SIZE);
+static struct k_thread render_thread;
+static struct k_thread hog_thread;
+
+static void fill_pixels(uint32_t seed)
+{
+	for (size_t i = 0; i < STRIP_LENGTH; i++) {
+		pixels[i].r = (uint8_t)(i * 7U + seed);
+		pixels[i].g = (uint8_t)(i * 13U + seed * 3U);
+		pixels[i].b = (uint8_t)(i * 29U + seed * 5U);
+	}
+}
+
+/* Reference bitstream of the pixels, GRB as in the overlay */
+static void encode_expected(void)
+{
+	static uint8_t bytes[STRIP_LENGTH * STRIP_COLORS];
+	const struct ws2812_encoding enc = {
+		.frequency = ws2812_timing_bus_frequency(FRAME_BITS, 0U, 0U),
+		.frame_bits = FRAME_BITS,
+		.one_frame = DT_PROP(STRIP_NODE, spi_one_frame),
+		.zero_frame = DT_PROP(STRIP_NODE, spi_zero_frame),
+	};
+
+	for (size_t i = 0; i < STRIP_LENGTH; i++) {
+		bytes[i * 3U] = pixels[i].g;
+		bytes[i * 3U + 1U] = pixels[i].r;
+		bytes[i * 3U + 2U] = pixels[i].b;
+	}
+
+	ws2812_timing_encode(&enc, bytes, ARRAY_SIZE(bytes), expected);
+}
+
+static void render(void *p1, void *p2, void *p3)
+{
+	ARG_UNUSED(p1);
+	ARG_UNUSED(p2);
+	ARG_UNUSED(p3);
+
+	render_rc = led_strip_update_rgb(strip, pixels, STRIP_LENGTH);
+}
+
+/* Keeps the CPU from the render thread while the interrupts still run */
+static void hog(void *p1, void *p2, void *p3)
+{
+	ARG_UNUSED(p1);
+	ARG_UNUSED(p2);
+	ARG_UNUSED(p3);
+
+	k_usleep(HOG_DELAY_US);
+	k_busy_wait(HOG_US);
+}
+
+/* Send one frame from a preemptible thread, as the player does */
+static int send_frame(bool starve, struct spi_wire_stats *stats)
+{
+	spi_wire_start(wire, LATCH_US, capture, sizeof(capture));
+
+	if (starve) {
+		k_thread_create(&hog_thread, hog_stack, K_THREAD_STACK_SIZEOF(hog_stack), hog,
+				NULL, NULL, NULL, HOG_PRIORITY, 0, K_NO_WAIT);
+	}
+	k_thread_create(&render_thread, render_stack, K_THREAD_STACK_SIZEOF(render_stack),
+			render, NULL, NULL, NULL, RENDER_PRIORITY, 0, K_NO_WAIT);
+
+	if (k_thread_join(&render_thread, K_SECONDS(1)) != 0) {
+		return -ETIMEDOUT;
+	}
+	if (starve) {
+		k_thread_join(&hog_thread, K_FOREVER);
+	}
+
+	spi_wire_stats_get(wire, stats);
+
+	return render_rc;
+}
+
+static void *ws2812_spi_stream_setup(void)
+{
+	zassert_true(device_is_ready(wire));
+	zassert_true(device_is_ready(strip));
+
+	return NULL;
+}
+
+ZTEST(ws2812_spi_stream, test_frame_matches_reference)
+{
+	struct spi_wire_stats stats;
+
+	fill_pixels(1U);
+	encode_expected();
+
+	zassert_ok(send_frame(false, &stats));
+	zassert_equal(stats.frame_len, FRAME_LEN, "%zu bytes sent", stats.frame_len);
+	zassert_mem_equal(capture, expected, FRAME_LEN);
+	zassert_true(stats.chunks > CONFIG_WS2812_STRIP_SPI_STREAM_CHUNKS,
+		     "frame fits the ring, nothing streamed");
+}
+
+ZTEST(ws2812_spi_stream, test_chunks_restart_before_latch)
+{
+	struct spi_wire_stats stats;
+
+	for (uint32_t frame = 0; frame < 16U; frame++) {
+		fill_pixels(frame);
+
+		zassert_ok(send_frame(false, &stats));
+		zassert_equal(stats.late_chunks, 0U, "frame %u: chunk started %u us after the wire went idle",
+			      frame, stats.max_gap_us);
+		zassert_equal(stats.frame_len, FRAME_LEN);
+	}
+}
+
+ZTEST(ws2812_spi_stream, test_starved_encoder_fails_frame)
+{
+	struct spi_wire_stats stats;
+
+	fill_pixels(2U);
+
+	/* The ring drains while the encoder cannot run: the frame is lost */
+	zassert_equal(send_frame(true, &stats), -EIO);
+	zassert_equal(stats.late_chunks, 0U, "chunk started %u us after the wire went idle",
+		      stats.max_gap_us);
+	zassert_true(stats.frame_len < FRAME_LEN);
+
+	/* And the next frame goes through */
+	zassert_ok(send_frame(false, &stats));
+	zassert_equal(stats.frame_len, FRAME_LEN);
+}
+
+ZTEST_SUITE(ws2812_spi_stream, NULL, ws2812_spi_stream_setup, NULL, NULL, NULL);
@@ -0,0 +1,160 @@
+/*
+ * Copyright (c) 2024 Romain Pelletant
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#include <zephyr/kernel.h>
+#include <zephyr/ztest.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <led_player/dither.h>
+#include <led_player/brightness.h>
+
+#define STRIP_LENGTH		64U
+/* A fraction shows over this many frames at most */
+#define FRAMES			(1U << BRIGHTNESS_LUT16_SHIFT)
+
+static struct dither dither;
+static struct pattern_rgb16 span[STRIP_LENGTH];
+static struct led_rgb pixels[STRIP_LENGTH];
+static uint32_t sums[STRIP_LENGTH][3];
+
+/* Q8.8 values of a dim strip, fractions from none to almost one */
+static const uint16_t values[] = { 0x0000U, 0x0001U, 0x0080U, 0x00FFU, 0x0100U, 0x0155U,
+				   0x0A40U, 0x1FFFU, 0xFE01U, 0xFF00U };
+
+static void fill_span(uint16_t r, uint16_t g, uint16_t b)
+{
+	for (size_t i = 0; i < STRIP_LENGTH; i++) {
+		span[i].r = r;
+		span[i].g = g;
+		span[i].b = b;
+	}
+}
+
+static void dither_setup_resize(void *fixture)
+{
+	ARG_UNUSED(fixture);
+
+	/* Fresh phases for every case */
+	zassert_ok(dither_resize(&dither, STRIP_LENGTH));
+}
+
+ZTEST(dither, test_average_is_exact)
+{
+	for (size_t v = 0; v < ARRAY_SIZE(values); v++) {
+		const uint16_t value = values[v];
+
+		fill_span(value, values[(v + 1U) % ARRAY_SIZE(values)],
+			  values[(v + 2U) % ARRAY_SIZE(values)]);
+		memset(sums, 0, sizeof(sums));
+
+		for (uint32_t frame = 1U; frame <= FRAMES; frame++) {
+			dither_span(&dither, pixels, span, 0U, STRIP_LENGTH);
+
+			for (size_t i = 0; i < STRIP_LENGTH; i++) {
+				const int32_t expected = value * frame;
+				int32_t error;
+
+				sums[i][0] += pixels[i].r;
+				sums[i][1] += pixels[i].g;
+				sums[i][2] += pixels[i].b;
+
+				/* Never more than one level off the running average */
+				error = (int32_t)(sums[i][0] << BRIGHTNESS_LUT16_SHIFT) - expected;
+				zassert_true(abs(error) < (int32_t)FRAMES,
+					     "0x%04x pixel %zu frame %u: error %d", value, i, frame,
+					     error);
+			}
+		}
+
+		/* Over a whole period, the levels shown add up to the value */
+		for (size_t i = 0; i < STRIP_LENGTH; i++) {
+			zassert_equal(sums[i][0], value, "0x%04x pixel %zu: %u", value, i,
+				      sums[i][0]);
+			zassert_equal(sums[i][1], span[i].g);
+			zassert_equal(sums[i][2], span[i].b);
+		}
+	}
+}
+
+ZTEST(dither, test_phases_spread_and_channels_step_together)
+{
+	size_t lit = 0U;
+
+	/* Half a level: a uniform strip must not blink all at once */
+	fill_span(0x0080U, 0x0080U, 0x0080U);
+	dither_span(&dither, pixels, span, 0U, STRIP_LENGTH);
+
+	for (size_t i = 0; i < STRIP_LENGTH; i++) {
+		lit += pixels[i].r;
+		/* Channels of a pixel share their phase: the hue holds */
+		zassert_equal(pixels[i].g, pixels[i].r, "pixel %zu", i);
+		zassert_equal(pixels[i].b, pixels[i].r, "pixel %zu", i);
+	}
+
+	zassert_within(lit, STRIP_LENGTH / 2U, STRIP_LENGTH / 8U, "%zu of %u pixels lit", lit,
+		       STRIP_LENGTH);
+}
+
+ZTEST(dither, test_spans_use_their_own_residuals)
+{
+	static struct led_rgb whole[STRIP_LENGTH];
+
+	fill_span(0x0155U, 0x0A40U, 0x00FFU);
+
+	/* Whole strip at once, then from the same seeded state */
+	dither_span(&dither, whole, span, 0U, STRIP_LENGTH);
+	zassert_ok(dither_resize(&dither, STRIP_LENGTH));
+
+	/* Same frame by uneven spans */
+	for (size_t start = 0U, count = 1U; start < STRIP_LENGTH; start += count, count++) {
+		count = MIN(count, STRIP_LENGTH - start);
+		dither_span(&dither, &pixels[start], &span[start], start, count);
+	}
+
+	zassert_mem_equal(pixels, whole, sizeof(pixels));
+}
+
+ZTEST(dither, test_settles_without_fraction)
+{
+	struct led_rgb first[STRIP_LENGTH];
+
+	fill_span(0x0155U, 0x0A40U, 0x00FFU);
+	zassert_true(dither_span(&dither, pixels, span, 0U, STRIP_LENGTH));
+	zassert_true(dither_span(&dither, pixels, span, 0U, STRIP_LENGTH));
+
+	/* One fractional channel is enough to keep moving */
+	fill_span(0x0100U, 0x0A00U, 0x0001U);
+	zassert_true(dither_span(&dither, pixels, span, 0U, STRIP_LENGTH));
+
+	/* Whole levels show as they are from the next frame on, whatever the residuals */
+	fill_span(0x0100U, 0x0A00U, 0xFF00U);
+	zassert_false(dither_span(&dither, first, span, 0U, STRIP_LENGTH));
+	for (size_t i = 0; i < STRIP_LENGTH; i++) {
+		zassert_equal(first[i].r, 0x01U, "pixel %zu", i);
+		zassert_equal(first[i].g, 0x0AU, "pixel %zu", i);
+		zassert_equal(first[i].b, 0xFFU, "pixel %zu", i);
+	}
+
+	for (uint32_t frame = 0; frame < FRAMES; frame++) {
+		zassert_false(dither_span(&dither, pixels, span, 0U, STRIP_LENGTH));
+		zassert_mem_equal(pixels, first, sizeof(pixels), "frame %u", frame);
+	}
+}
+
+ZTEST(dither, test_resize_past_arena)
+{
+	/* Three bytes per LED do not fit: dithering is turned off */
+	zassert_equal(dither_resize(&dither, CONFIG_APP_FRAME_ARENA_SIZE), -ENOMEM);
+	zassert_is_null(dither.residual);
+	zassert_equal(dither.length, 0U);
+
+	/* And back on when the strip fits again */
+	zassert_ok(dither_resize(&dither, STRIP_LENGTH));
+	zassert_not_null(dither.residual);
+	zassert_equal(dither.length, STRIP_LENGTH);
+}
+
+ZTEST_SUITE(dither, NULL, NULL, dither_setup_resize, NULL, NULL);
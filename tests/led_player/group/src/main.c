@@ -0,0 +1,440 @@
+/*
+ * Copyright (c) 2024 Romain Pelletant
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#include <zephyr/kernel.h>
+#include <zephyr/ztest.h>
+#include <zephyr/drivers/led_strip.h>
+#include <zephyr/dt-bindings/led/led.h>
+#include <string.h>
+
+#include <led_player/backend/backend.h>
+#include <led_player/backend/ws2812_timing.h>
+#include <led_player/frame_arena.h>
+
+#include <spi_wire.h>
+
+/* Sum of the chain lengths of the overlay */
+#define GROUP_LENGTH		16U
+#define LENGTH_MAX		32U
+/* 8-bit frames of three channels */
+#define CAPTURE_SIZE		(LENGTH_MAX * 3U * 8U)
+#define LATCH_US		280U
+/* strip_a, resized first, fits in the frame arena, strip_b does not */
+#define LENGTH_TOO_LONG		400U
+
+/**< @brief A strip of the group, the bus it is on and what its frames look like >*/
+struct test_strip {
+	const struct device *dev;
+	const struct device *wire;
+	const uint8_t *mapping;
+	uint8_t num_colors;
+	uint8_t one_frame;
+	uint8_t zero_frame;
+	uint8_t *capture;
+};
+
+static uint8_t capture_a[CAPTURE_SIZE];
+static uint8_t capture_b[CAPTURE_SIZE];
+
+#define TEST_STRIP(_node, _capture)						\
+	{									\
+		.dev = DEVICE_DT_GET(_node),					\
+		.wire = DEVICE_DT_GET(DT_BUS(_node)),				\
+		.mapping = (const uint8_t[])DT_PROP(_node, color_mapping),	\
+		.num_colors = DT_PROP_LEN(_node, color_mapping),		\
+		.one_frame = DT_PROP(_node, spi_one_frame),			\
+		.zero_frame = DT_PROP(_node, spi_zero_frame),			\
+		.capture = _capture,						\
+	}
+
+/* In the order of the led-strips property */
+static const struct test_strip strips[] = {
+	TEST_STRIP(DT_NODELABEL(strip_a), capture_a),
+	TEST_STRIP(DT_NODELABEL(strip_b), capture_b),
+};
+
+extern const struct led_backend led_backend_group;
+
+static const struct device *group;
+static struct led_rgb pixels[LENGTH_MAX];
+static uint8_t expected[CAPTURE_SIZE];
+static uint8_t indices[LENGTH_MAX];
+static uint16_t rgb565[LENGTH_MAX];
+static struct led_rgb palette[LED_STRIP_PALETTE_SIZE];
+
+static K_SEM_DEFINE(flushed, 0, 2);
+static atomic_t callbacks;
+static int flush_result;
+
+/* Frame width the driver picks from the frames */
+static uint8_t frame_bits_of(const struct test_strip *strip)
+{
+	const uint8_t frames = strip->one_frame | strip->zero_frame;
+
+	return frames < BIT(3) ? 3U : frames < BIT(4) ? 4U : 8U;
+}
+
+static void fill_pixels(size_t count, uint32_t seed)
+{
+	for (size_t i = 0; i < count; i++) {
+		pixels[i].r = (uint8_t)(i * 7U + seed);
+		pixels[i].g = (uint8_t)(i * 13U + seed * 3U);
+		pixels[i].b = (uint8_t)(i * 29U + seed * 5U);
+	}
+}
+
+/* Reference bitstream of count pixels from first, one bit at a time */
+static size_t encode_expected(const struct test_strip *strip, const struct led_rgb *first,
+			      size_t count)
+{
+	static uint8_t bytes[LENGTH_MAX * 3U];
+	const struct ws2812_encoding enc = {
+		.frame_bits = frame_bits_of(strip),
+		.one_frame = strip->one_frame,
+		.zero_frame = strip->zero_frame,
+	};
+	size_t len = 0U;
+
+	for (size_t i = 0; i < count; i++) {
+		for (size_t j = 0; j < strip->num_colors; j++) {
+			switch (strip->mapping[j]) {
+			case LED_COLOR_ID_RED:
+				bytes[len++] = first[i].r;
+				break;
+			case LED_COLOR_ID_GREEN:
+				bytes[len++] = first[i].g;
+				break;
+			default:
+				bytes[len++] = first[i].b;
+				break;
+			}
+		}
+	}
+
+	ws2812_timing_encode(&enc, bytes, len, expected);
+
+	return len * enc.frame_bits;
+}
+
+static void flush_done(const struct device *dev, int result, void *user_data)
+{
+	ARG_UNUSED(dev);
+	ARG_UNUSED(user_data);
+
+	flush_result = result;
+	atomic_inc(&callbacks);
+	k_sem_give(&flushed);
+}
+
+/* Capture the next frame of both buses, faults cleared */
+static void wires_start(void)
+{
+	for (size_t s = 0; s < ARRAY_SIZE(strips); s++) {
+		spi_wire_start(strips[s].wire, LATCH_US, strips[s].capture, CAPTURE_SIZE);
+	}
+
+	atomic_clear(&callbacks);
+	k_sem_reset(&flushed);
+}
+
+static int group_send(size_t head)
+{
+	if (head == led_strip_length(group)) {
+		return led_strip_flush_async(group, flush_done, NULL);
+	}
+
+	return led_strip_flush_prefix_async(group, head, flush_done, NULL);
+}
+
+/* The frame ends with one callback, whatever the number of strips */
+static void check_one_callback(int result)
+{
+	zassert_ok(k_sem_take(&flushed, K_SECONDS(1)));
+	zassert_equal(flush_result, result, "result %d", flush_result);
+
+	/* Both strips latched long before */
+	zassert_equal(k_sem_take(&flushed, K_MSEC(10)), -EAGAIN);
+	zassert_equal(atomic_get(&callbacks), 1);
+}
+
+/* Each strip sent its range of the first head pixels, nothing past it */
+static void check_wires(size_t head)
+{
+	size_t start = 0U;
+
+	for (size_t s = 0; s < ARRAY_SIZE(strips); s++) {
+		const struct test_strip *strip = &strips[s];
+		const size_t length = led_strip_length(strip->dev);
+		const size_t count = start < head ? MIN(length, head - start) : 0U;
+		const size_t len = encode_expected(strip, &pixels[start], count);
+		struct spi_wire_stats stats;
+
+		spi_wire_stats_get(strip->wire, &stats);
+		zassert_equal(stats.chunks, count ? 1U : 0U, "%s head %zu: %u transfers",
+			      strip->dev->name, head, stats.chunks);
+		zassert_equal(stats.frame_len, len, "%s head %zu: %zu bytes sent",
+			      strip->dev->name, head, stats.frame_len);
+		zassert_mem_equal(strip->capture, expected, len, "%s head %zu",
+				  strip->dev->name, head);
+
+		start += length;
+	}
+}
+
+static void flush_and_check(size_t head)
+{
+	wires_start();
+	zassert_ok(group_send(head));
+	check_one_callback(0);
+	check_wires(head);
+}
+
+static void *group_setup(void)
+{
+	group = led_backend_group.dev;
+	zassert_true(device_is_ready(group));
+
+	for (size_t s = 0; s < ARRAY_SIZE(strips); s++) {
+		zassert_true(device_is_ready(strips[s].dev));
+		zassert_true(device_is_ready(strips[s].wire));
+	}
+
+	for (size_t i = 0; i < LED_STRIP_PALETTE_SIZE; i++) {
+		palette[i].r = (uint8_t)(i * 3U);
+		palette[i].g = (uint8_t)(255U - i);
+		palette[i].b = (uint8_t)(i ^ 0x5aU);
+	}
+
+	return NULL;
+}
+
+static void group_after(void *fixture)
+{
+	ARG_UNUSED(fixture);
+
+	wires_start();
+	zassert_ok(led_strip_set_length(group, GROUP_LENGTH));
+}
+
+ZTEST(group, test_spans_split_at_boundary)
+{
+	/* strip_a drives [0, 10), the third span crosses over to strip_b */
+	static const size_t spans[] = { 3U, 4U, 5U, 4U };
+	static const size_t compact_spans[] = { 9U, 2U, 5U };
+	size_t offset = 0U;
+
+	zassert_equal(led_strip_length(group), GROUP_LENGTH);
+	zassert_equal(led_strip_length(strips[0].dev), 10U);
+	zassert_equal(led_strip_length(strips[1].dev), 6U);
+
+	fill_pixels(GROUP_LENGTH, 3U);
+	for (size_t i = 0; i < ARRAY_SIZE(spans); i++) {
+		zassert_ok(led_strip_encode_span(group, offset, &pixels[offset], spans[i]));
+		offset += spans[i];
+	}
+	flush_and_check(GROUP_LENGTH);
+
+	offset = 0U;
+	for (size_t i = 0; i < GROUP_LENGTH; i++) {
+		indices[i] = (uint8_t)(i * 53U + 1U);
+		pixels[i] = palette[indices[i]];
+	}
+	for (size_t i = 0; i < ARRAY_SIZE(compact_spans); i++) {
+		zassert_ok(led_strip_encode_span_format(group, offset, LED_STRIP_FORMAT_INDEX8,
+							&indices[offset], compact_spans[i],
+							palette));
+		offset += compact_spans[i];
+	}
+	flush_and_check(GROUP_LENGTH);
+
+	for (size_t i = 0; i < GROUP_LENGTH; i++) {
+		const uint16_t value = (uint16_t)(i * 2897U + 611U);
+		const uint8_t r = value >> 11;
+		const uint8_t g = (value >> 5) & 0x3fU;
+		const uint8_t b = value & 0x1fU;
+
+		rgb565[i] = value;
+		pixels[i].r = (r << 3) | (r >> 2);
+		pixels[i].g = (g << 2) | (g >> 4);
+		pixels[i].b = (b << 3) | (b >> 2);
+	}
+	zassert_ok(led_strip_encode_span_format(group, 0U, LED_STRIP_FORMAT_RGB565, rgb565,
+						GROUP_LENGTH, NULL));
+	flush_and_check(GROUP_LENGTH);
+
+	/* Past the end of the group, whatever the children would take */
+	zassert_equal(led_strip_encode_span(group, 12U, pixels, 5U), -ERANGE);
+	zassert_equal(led_strip_encode_span(group, GROUP_LENGTH + 1U, pixels, 0U), -ERANGE);
+}
+
+ZTEST(group, test_runs_split_at_boundary)
+{
+	/* The run of 9 crosses over to strip_b, empty runs are skipped */
+	static const struct led_strip_run runs[] = {
+		{ .length = 0U, .color = { .r = 0x11U, .g = 0x22U, .b = 0x33U } },
+		{ .length = 4U, .color = { .r = 0xF0U, .g = 0x0FU, .b = 0x80U } },
+		{ .length = 0U, .color = { .r = 0x44U, .g = 0x55U, .b = 0x66U } },
+		{ .length = 9U, .color = { .r = 0x01U, .g = 0xFEU, .b = 0x5AU } },
+		{ .length = 3U, .color = { .r = 0xA5U, .g = 0x00U, .b = 0xFFU } },
+	};
+	static const struct led_strip_run tail[] = {
+		{ .length = 2U, .color = { .r = 0x12U, .g = 0x34U, .b = 0x56U } },
+		{ .length = 5U, .color = { .r = 0x9AU, .g = 0xBCU, .b = 0xDEU } },
+	};
+	size_t pos = 0U;
+
+	for (size_t r = 0; r < ARRAY_SIZE(runs); r++) {
+		for (size_t i = 0; i < runs[r].length; i++) {
+			pixels[pos++] = runs[r].color;
+		}
+	}
+	zassert_ok(led_strip_encode_runs(group, 0U, runs, ARRAY_SIZE(runs)));
+	flush_and_check(GROUP_LENGTH);
+
+	/* From an offset, over a frame encoded pixel by pixel */
+	fill_pixels(GROUP_LENGTH, 5U);
+	zassert_ok(led_strip_encode_span(group, 0U, pixels, GROUP_LENGTH));
+	pos = 8U;
+	for (size_t r = 0; r < ARRAY_SIZE(tail); r++) {
+		for (size_t i = 0; i < tail[r].length; i++) {
+			pixels[pos++] = tail[r].color;
+		}
+	}
+	zassert_ok(led_strip_encode_runs(group, 8U, tail, ARRAY_SIZE(tail)));
+	flush_and_check(GROUP_LENGTH);
+
+	zassert_equal(led_strip_encode_runs(group, 10U, tail, ARRAY_SIZE(tail)), -ERANGE);
+	zassert_equal(led_strip_encode_runs(group, GROUP_LENGTH + 1U, tail, 0U), -ERANGE);
+}
+
+ZTEST(group, test_prefix_heads)
+{
+	/* Within strip_a, on the boundary and past it */
+	static const size_t heads[] = { 1U, 9U, 10U, 11U, 15U, GROUP_LENGTH };
+
+	for (size_t h = 0; h < ARRAY_SIZE(heads); h++) {
+		fill_pixels(GROUP_LENGTH, 40U + h);
+		zassert_ok(led_strip_encode_span(group, 0U, pixels, heads[h]));
+		flush_and_check(heads[h]);
+	}
+
+	wires_start();
+	zassert_equal(led_strip_flush_prefix_async(group, GROUP_LENGTH + 1U, flush_done, NULL),
+		      -ERANGE);
+	zassert_equal(k_sem_take(&flushed, K_MSEC(10)), -EAGAIN);
+}
+
+ZTEST(group, test_one_callback_first_error)
+{
+	fill_pixels(GROUP_LENGTH, 7U);
+	zassert_ok(led_strip_encode_span(group, 0U, pixels, GROUP_LENGTH));
+
+	/* One strip fails once sent */
+	wires_start();
+	spi_wire_fail(strips[1].wire, 0, -EIO);
+	zassert_ok(group_send(GROUP_LENGTH));
+	check_one_callback(-EIO);
+
+	/* strip_b refused before strip_a fails: the first error is reported */
+	wires_start();
+	spi_wire_fail(strips[0].wire, 0, -EIO);
+	spi_wire_fail(strips[1].wire, -EBUSY, 0);
+	zassert_ok(group_send(GROUP_LENGTH));
+	check_one_callback(-EBUSY);
+
+	/* First strip refused: nothing started, the caller gets the error instead */
+	wires_start();
+	spi_wire_fail(strips[0].wire, -EBUSY, 0);
+	zassert_equal(group_send(GROUP_LENGTH), -EBUSY);
+	zassert_equal(k_sem_take(&flushed, K_MSEC(10)), -EAGAIN);
+	check_wires(0U);
+
+	/* And the group sends again */
+	fill_pixels(GROUP_LENGTH, 8U);
+	zassert_ok(led_strip_encode_span(group, 0U, pixels, GROUP_LENGTH));
+	flush_and_check(GROUP_LENGTH);
+}
+
+ZTEST(group, test_set_length_splits)
+{
+	zassert_ok(led_strip_set_length(group, LENGTH_MAX));
+	zassert_equal(led_strip_length(group), LENGTH_MAX);
+	zassert_equal(led_strip_length(strips[0].dev), 20U);
+	zassert_equal(led_strip_length(strips[1].dev), 12U);
+
+	fill_pixels(LENGTH_MAX, 21U);
+	zassert_ok(led_strip_encode_span(group, 0U, pixels, LENGTH_MAX));
+	flush_and_check(LENGTH_MAX);
+
+	/* Every frame is encoded in the buffer that is not on the wire */
+	zassert_ok(led_strip_encode_span(group, 0U, pixels, 19U));
+	flush_and_check(19U);
+
+	/* Uneven split, the ranges still add up */
+	zassert_ok(led_strip_set_length(group, 17U));
+	zassert_equal(led_strip_length(strips[0].dev), 10U);
+	zassert_equal(led_strip_length(strips[1].dev), 7U);
+
+	fill_pixels(17U, 22U);
+	zassert_ok(led_strip_encode_span(group, 0U, pixels, 17U));
+	flush_and_check(17U);
+
+	/* A strip with no pixel is not a group */
+	zassert_equal(led_strip_set_length(group, 1U), -EINVAL);
+	zassert_equal(led_strip_length(group), 17U);
+}
+
+ZTEST(group, test_set_length_rollback)
+{
+	/* strip_a gets its frames from the arena, strip_b runs out of it */
+	zassert_equal(led_strip_set_length(group, LENGTH_TOO_LONG), -ENOMEM);
+
+	zassert_equal(led_strip_length(group), GROUP_LENGTH);
+	zassert_equal(led_strip_length(strips[0].dev), 10U);
+	zassert_equal(led_strip_length(strips[1].dev), 6U);
+
+	/* Frames still go to the same ranges */
+	fill_pixels(GROUP_LENGTH, 33U);
+	zassert_ok(led_strip_encode_span(group, 0U, pixels, GROUP_LENGTH));
+	flush_and_check(GROUP_LENGTH);
+
+	zassert_ok(led_strip_encode_span(group, 0U, pixels, 12U));
+	flush_and_check(12U);
+}
+
+ZTEST(group, test_strip_resize_past_arena)
+{
+	const struct test_strip *strip = &strips[1];
+	/* One 8-bit frame of that length fits in the arena, the second one does not */
+	const size_t too_long = CONFIG_APP_FRAME_ARENA_SIZE / (2U * 3U * 8U);
+	struct frame_arena_stats before;
+	struct frame_arena_stats after;
+	size_t len;
+
+	fill_pixels(GROUP_LENGTH, 50U);
+	zassert_ok(led_strip_encode_span(group, 0U, pixels, GROUP_LENGTH));
+	flush_and_check(GROUP_LENGTH);
+
+	zassert_ok(frame_arena_get_stats(&before));
+	zassert_equal(led_strip_set_length(strip->dev, too_long), -ENOMEM);
+	zassert_equal(led_strip_length(strip->dev), 6U);
+	zassert_ok(frame_arena_get_stats(&after));
+	zassert_equal(after.used, before.used, "%zu bytes used, %zu before", after.used,
+		      before.used);
+
+	/* The frame sent is still there to be sent again */
+	wires_start();
+	zassert_ok(led_strip_rotate_async(strip->dev, 0U, flush_done, NULL));
+	check_one_callback(0);
+	len = encode_expected(strip, &pixels[led_strip_length(strips[0].dev)], 6U);
+	zassert_mem_equal(strip->capture, expected, len);
+
+	/* And the next frame is encoded in the buffers kept */
+	fill_pixels(GROUP_LENGTH, 51U);
+	zassert_ok(led_strip_encode_span(group, 0U, pixels, GROUP_LENGTH));
+	flush_and_check(GROUP_LENGTH);
+}
+
+ZTEST_SUITE(group, NULL, group_setup, NULL, group_after, NULL);
@@ -0,0 +1,255 @@
+/*
+ * Copyright (c) 2024 Romain Pelletant
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#include <zephyr/kernel.h>
+#include <zephyr/ztest.h>
+#include <stdlib.h>
+
+#include <led_player/pattern/hsv.h>
+
+#include <bench.h>
+
+#define HUES			0x10000U
+#define SECTORS			6U
+#define BENCH_ROUNDS		64U
+/* One span per pattern render, the size of a long strip */
+#define SPAN_LENGTH		1024U
+
+static uint16_t hues[SPAN_LENGTH];
+static struct led_rgb span[SPAN_LENGTH];
+
+/* Conversion unicolor_custom used before the shared engine */
+static uint32_t old_hsv_to_rgb32(uint16_t h)
+{
+	uint32_t hf = (h * 36000U) / 65535U;
+	uint32_t s = 100U;
+	uint32_t v = 100U;
+	uint32_t c = (v * s) / 100U;
+	uint32_t mod_hf = (hf % 6000U);
+	uint32_t x = (c * (100U - abs((mod_hf * 2U / 100U) - 100U))) / 100U;
+	uint32_t m = v - c;
+	uint32_t rf = 0U;
+	uint32_t gf = 0U;
+	uint32_t bf = 0U;
+
+	if (hf < 6000U) {
+		rf = c; gf = x; bf = 0U;
+	} else if (hf < 12000U) {
+		rf = x; gf = c; bf = 0U;
+	} else if (hf < 18000U) {
+		rf = 0U; gf = c; bf = x;
+	} else if (hf < 24000U) {
+		rf = 0U; gf = x; bf = c;
+	} else if (hf < 30000U) {
+		rf = x; gf = 0U; bf = c;
+	} else {
+		rf = c; gf = 0U; bf = x;
+	}
+
+	uint8_t r = (rf + m) * 255U / 100U;
+	uint8_t g = (gf + m) * 255U / 100U;
+	uint8_t b = (bf + m) * 255U / 100U;
+
+	return (r << 16) | (g << 8) | b;
+}
+
+/* Exact conversion, rounded to nearest */
+static uint32_t reference_hsv_to_rgb32(uint16_t hue)
+{
+	const uint32_t position = hue * SECTORS;
+	const uint32_t rise = ((position & 0xFFFFU) * 255U + 0x8000U) >> 16;
+	const uint32_t fall = 255U - rise;
+
+	switch (position >> 16) {
+	case 0:
+		return (255U << 16) | (rise << 8);
+	case 1:
+		return (fall << 16) | (255U << 8);
+	case 2:
+		return (255U << 8) | rise;
+	case 3:
+		return (fall << 8) | 255U;
+	case 4:
+		return (rise << 16) | 255U;
+	default:
+		return (255U << 16) | fall;
+	}
+}
+
+/* Largest channel difference of two 0x00RRGGBB colors */
+static uint32_t channel_error(uint32_t a, uint32_t b)
+{
+	uint32_t error = 0U;
+
+	for (int shift = 0; shift < 24; shift += 8) {
+		const int32_t diff = (int32_t)((a >> shift) & 0xFF) - (int32_t)((b >> shift) & 0xFF);
+
+		error = MAX(error, (uint32_t)abs(diff));
+	}
+
+	return error;
+}
+
+ZTEST(hsv, test_primaries_match_old_function)
+{
+	zassert_equal(hsv_to_rgb32(HSV_HUE_RED), 0xFF0000U);
+	zassert_equal(hsv_to_rgb32(HSV_HUE_GREEN), 0x00FF00U);
+	zassert_equal(hsv_to_rgb32(HSV_HUE_BLUE), 0x0000FFU);
+
+	zassert_equal(hsv_to_rgb32(HSV_HUE_RED), old_hsv_to_rgb32(HSV_HUE_RED));
+	zassert_equal(hsv_to_rgb32(HSV_HUE_GREEN), old_hsv_to_rgb32(HSV_HUE_GREEN));
+	zassert_equal(hsv_to_rgb32(HSV_HUE_BLUE), old_hsv_to_rgb32(HSV_HUE_BLUE));
+}
+
+ZTEST(hsv, test_every_hue_within_one_lsb)
+{
+	uint32_t old_max = 0U;
+
+	for (uint32_t hue = 0; hue < HUES; hue++) {
+		const uint32_t expected = reference_hsv_to_rgb32(hue);
+		const uint32_t error = channel_error(hsv_to_rgb32(hue), expected);
+
+		zassert_true(error <= 1U, "hue 0x%04x: 0x%06x, expected 0x%06x", hue,
+			     hsv_to_rgb32(hue), expected);
+		old_max = MAX(old_max, channel_error(old_hsv_to_rgb32(hue), expected));
+	}
+
+	TC_PRINT("old function was off by up to %u\n", old_max);
+}
+
+ZTEST(hsv, test_sector_edges_continuous)
+{
+	/* No channel jumps from one hue to the next, the old function did at 60 degrees */
+	for (uint32_t hue = 0; hue < HUES; hue++) {
+		const uint32_t next = (hue + 1U) % HUES;
+
+		zassert_true(channel_error(hsv_to_rgb32(hue), hsv_to_rgb32(next)) <= 1U,
+			     "hue 0x%04x to 0x%04x", hue, next);
+	}
+}
+
+static uint32_t rgb32(struct led_rgb rgb)
+{
+	return (rgb.r << 16) | (rgb.g << 8) | rgb.b;
+}
+
+ZTEST(hsv, test_span_matches_old_function)
+{
+	static const uint16_t primaries[] = { HSV_HUE_RED, HSV_HUE_GREEN, HSV_HUE_BLUE };
+	struct led_rgb pixels[ARRAY_SIZE(primaries)];
+
+	hsv_to_rgb_span(primaries, pixels, ARRAY_SIZE(primaries), UINT8_MAX, UINT8_MAX);
+	for (size_t i = 0; i < ARRAY_SIZE(primaries); i++) {
+		zassert_equal(rgb32(pixels[i]), old_hsv_to_rgb32(primaries[i]), "hue 0x%04x",
+			      primaries[i]);
+	}
+
+	/* Where the old function was right, within one LSB of it */
+	for (uint32_t base = 0; base < HUES; base += SPAN_LENGTH) {
+		for (size_t i = 0; i < SPAN_LENGTH; i++) {
+			hues[i] = base + i;
+		}
+		hsv_to_rgb_span(hues, span, SPAN_LENGTH, UINT8_MAX, UINT8_MAX);
+
+		for (size_t i = 0; i < SPAN_LENGTH; i++) {
+			const uint32_t expected = reference_hsv_to_rgb32(hues[i]);
+
+			zassert_true(channel_error(rgb32(span[i]), expected) <= 1U,
+				     "hue 0x%04x: 0x%06x, expected 0x%06x", hues[i],
+				     rgb32(span[i]), expected);
+			if (channel_error(old_hsv_to_rgb32(hues[i]), expected) == 0U) {
+				zassert_true(channel_error(rgb32(span[i]),
+							   old_hsv_to_rgb32(hues[i])) <= 1U,
+					     "hue 0x%04x", hues[i]);
+			}
+		}
+	}
+}
+
+ZTEST(hsv, test_span_matches_single)
+{
+	static const uint8_t levels[] = { 0U, 1U, 100U, 254U, UINT8_MAX };
+
+	for (size_t i = 0; i < SPAN_LENGTH; i++) {
+		hues[i] = i * 67U;
+	}
+
+	for (size_t s = 0; s < ARRAY_SIZE(levels); s++) {
+		for (size_t v = 0; v < ARRAY_SIZE(levels); v++) {
+			hsv_to_rgb_span(hues, span, SPAN_LENGTH, levels[s], levels[v]);
+
+			for (size_t i = 0; i < SPAN_LENGTH; i++) {
+				const struct led_rgb rgb = hsv_to_rgb(hues[i], levels[s], levels[v]);
+
+				zassert_equal(rgb32(span[i]), rgb32(rgb), "hue 0x%04x s %u v %u",
+					      hues[i], levels[s], levels[v]);
+			}
+		}
+
+		/* No saturation is grey at the value */
+		hsv_to_rgb_span(hues, span, 1U, 0U, levels[s]);
+		zassert_equal(rgb32(span[0]), levels[s] * 0x010101U);
+	}
+}
+
+ZTEST(hsv, test_benchmark)
+{
+	volatile uint32_t sink = 0U;
+	uint64_t begin;
+	uint64_t old_ns;
+	uint64_t new_ns;
+
+	begin = bench_now_ns();
+	for (uint32_t round = 0; round < BENCH_ROUNDS; round++) {
+		for (uint32_t hue = 0; hue < HUES; hue++) {
+			sink += old_hsv_to_rgb32(hue);
+		}
+	}
+	old_ns = bench_now_ns() - begin;
+
+	begin = bench_now_ns();
+	for (uint32_t round = 0; round < BENCH_ROUNDS; round++) {
+		for (uint32_t hue = 0; hue < HUES; hue++) {
+			sink += hsv_to_rgb32(hue);
+		}
+	}
+	new_ns = bench_now_ns() - begin;
+
+	TC_PRINT("per hue: old %llu ps, new %llu ps\n",
+		 (unsigned long long)(old_ns * 1000U / (BENCH_ROUNDS * HUES)),
+		 (unsigned long long)(new_ns * 1000U / (BENCH_ROUNDS * HUES)));
+
+	/* A rainbow span: the old function per pixel, then the batch entry point */
+	for (size_t i = 0; i < SPAN_LENGTH; i++) {
+		hues[i] = i * (HUES / SPAN_LENGTH);
+	}
+
+	begin = bench_now_ns();
+	for (uint32_t round = 0; round < BENCH_ROUNDS * HUES / SPAN_LENGTH; round++) {
+		for (size_t i = 0; i < SPAN_LENGTH; i++) {
+			const uint32_t rgb = old_hsv_to_rgb32(hues[i]);
+
+			span[i].r = rgb >> 16;
+			span[i].g = rgb >> 8;
+			span[i].b = rgb;
+		}
+		compiler_barrier();
+	}
+	old_ns = bench_now_ns() - begin;
+
+	begin = bench_now_ns();
+	for (uint32_t round = 0; round < BENCH_ROUNDS * HUES / SPAN_LENGTH; round++) {
+		hsv_to_rgb_span(hues, span, SPAN_LENGTH, UINT8_MAX, UINT8_MAX);
+		compiler_barrier();
+	}
+	new_ns = bench_now_ns() - begin;
+
+	TC_PRINT("per pixel of a %u pixel span: old %llu ps, span %llu ps\n", SPAN_LENGTH,
+		 (unsigned long long)(old_ns * 1000U / (BENCH_ROUNDS * HUES)),
+		 (unsigned long long)(new_ns * 1000U / (BENCH_ROUNDS * HUES)));
+	ARG_UNUSED(sink);
+}
+
+ZTEST_SUITE(hsv, NULL, NULL, NULL, NULL, NULL);
@@ -0,0 +1,340 @@
+/*
+ * Copyright (c) 2024 Romain Pelletant
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#include <zephyr/kernel.h>
+#include <zephyr/ztest.h>
+#include <string.h>
+
+#include <led_player/pattern/pixel_ops.h>
+
+#include <bench.h>
+
+/* Spans up to several words on each side of the SWAR loop */
+#define SPAN_MAX		40U
+/* Room for a misaligned span and a guard byte on each side */
+#define ARENA_SIZE		(SPAN_MAX * sizeof(struct pattern_rgb16) + 16U)
+#define GUARD			0xA5U
+
+#define BENCH_PIXELS		1000U
+#define BENCH_ROUNDS		2000U
+
+static uint8_t arena[ARENA_SIZE] __aligned(8);
+static uint8_t expected[ARENA_SIZE] __aligned(8);
+static uint8_t other[ARENA_SIZE] __aligned(8);
+
+static struct led_rgb bench_pixels[BENCH_PIXELS];
+static struct led_rgb bench_other[BENCH_PIXELS];
+
+/* Blend weights and scales, out of range ones included */
+static const uint16_t weights[] = { 0U, 1U, 77U, 128U, 255U, PIXEL_OPS_ONE, 300U };
+static const uint8_t amounts[] = { 0U, 1U, 64U, 128U, 255U };
+
+/**< @brief An operation on the benchmark spans, SWAR and scalar >*/
+struct bench_op {
+	const char *name;
+	void (*swar)(void);
+	void (*scalar)(void);
+};
+
+/* Byte by byte, as the scalar head and tail of pixel_blend() */
+static void scalar_blend(uint8_t *a, const uint8_t *b, size_t len, uint16_t weight)
+{
+	const uint32_t w = MIN(weight, PIXEL_OPS_ONE);
+
+	for (size_t i = 0; i < len; i++) {
+		a[i] = (a[i] * (PIXEL_OPS_ONE - w) + b[i] * w) >> 8;
+	}
+}
+
+static void scalar_scale(uint8_t *bytes, size_t len, uint16_t scale)
+{
+	if (scale >= PIXEL_OPS_ONE) {
+		return;
+	}
+
+	for (size_t i = 0; i < len; i++) {
+		bytes[i] = (bytes[i] * scale) >> 8;
+	}
+}
+
+static void scalar_add_saturate(uint8_t *a, const uint8_t *b, size_t len)
+{
+	for (size_t i = 0; i < len; i++) {
+		a[i] = MIN(a[i] + b[i], UINT8_MAX);
+	}
+}
+
+static void scalar_fill(uint8_t *dst, size_t count, const void *pixel, size_t size)
+{
+	for (size_t i = 0; i < count; i++) {
+		memcpy(&dst[i * size], pixel, size);
+	}
+}
+
+static void fill_bytes(uint8_t *bytes, size_t len, uint32_t seed)
+{
+	for (size_t i = 0; i < len; i++) {
+		bytes[i] = (uint8_t)(i * 29U + seed * 101U);
+	}
+	/* Both ends of the channel range */
+	bytes[1] = 0x00U;
+	bytes[2] = 0xFFU;
+}
+
+ZTEST(pixel_ops, test_fill_matches_scalar)
+{
+	const struct led_rgb color = { .r = 0x12U, .g = 0xEDU, .b = 0x80U };
+
+	for (size_t count = 0; count < SPAN_MAX; count++) {
+		for (size_t offset = 1; offset <= 4U; offset++) {
+			memset(arena, GUARD, sizeof(arena));
+			memset(expected, GUARD, sizeof(expected));
+
+			pixel_fill((struct led_rgb *) &arena[offset], count, color);
+			scalar_fill(&expected[offset], count, &color, sizeof(color));
+
+			/* Bytes around the span included */
+			zassert_mem_equal(arena, expected, sizeof(arena), "%zu pixels at +%zu",
+					  count, offset);
+		}
+	}
+}
+
+ZTEST(pixel_ops, test_fill16_matches_scalar)
+{
+	const struct pattern_rgb16 color = { .r = 0x1234U, .g = 0xFFFFU, .b = 0x0080U };
+
+	for (size_t count = 0; count < SPAN_MAX; count++) {
+		for (size_t offset = 2; offset <= 8U; offset += sizeof(uint16_t)) {
+			memset(arena, GUARD, sizeof(arena));
+			memset(expected, GUARD, sizeof(expected));
+
+			pixel_fill16((struct pattern_rgb16 *) &arena[offset], count, color);
+			scalar_fill(&expected[offset], count, &color, sizeof(color));
+
+			zassert_mem_equal(arena, expected, sizeof(arena), "%zu pixels at +%zu",
+					  count, offset);
+		}
+	}
+}
+
+ZTEST(pixel_ops, test_blend_matches_scalar)
+{
+	for (size_t w = 0; w < ARRAY_SIZE(weights); w++) {
+		for (size_t count = 0; count < SPAN_MAX; count++) {
+			const size_t len = count * sizeof(struct led_rgb);
+
+			/* Same and different alignments of both spans */
+			for (size_t offset = 1; offset <= 4U; offset++) {
+				for (size_t other_offset = 1; other_offset <= 4U; other_offset++) {
+					memset(arena, GUARD, sizeof(arena));
+					fill_bytes(&arena[offset], len, count);
+					fill_bytes(&other[other_offset], len, count + 7U);
+					memcpy(expected, arena, sizeof(arena));
+
+					pixel_blend((struct led_rgb *) &arena[offset],
+						    (const struct led_rgb *) &other[other_offset],
+						    count, weights[w]);
+					scalar_blend(&expected[offset], &other[other_offset], len,
+						     weights[w]);
+
+					zassert_mem_equal(arena, expected, sizeof(arena),
+							  "weight %u, %zu pixels at +%zu/+%zu",
+							  weights[w], count, offset, other_offset);
+				}
+			}
+		}
+	}
+}
+
+ZTEST(pixel_ops, test_scale_matches_scalar)
+{
+	for (size_t w = 0; w < ARRAY_SIZE(weights); w++) {
+		for (size_t count = 0; count < SPAN_MAX; count++) {
+			const size_t len = count * sizeof(struct led_rgb);
+
+			for (size_t offset = 1; offset <= 4U; offset++) {
+				memset(arena, GUARD, sizeof(arena));
+				fill_bytes(&arena[offset], len, count);
+				memcpy(expected, arena, sizeof(arena));
+
+				pixel_scale((struct led_rgb *) &arena[offset], count, weights[w]);
+				scalar_scale(&expected[offset], len, weights[w]);
+
+				zassert_mem_equal(arena, expected, sizeof(arena),
+						  "scale %u, %zu pixels at +%zu", weights[w], count,
+						  offset);
+			}
+		}
+	}
+}
+
+ZTEST(pixel_ops, test_fade_to_black_matches_scalar)
+{
+	for (size_t a = 0; a < ARRAY_SIZE(amounts); a++) {
+		for (size_t count = 0; count < SPAN_MAX; count++) {
+			const size_t len = count * sizeof(struct led_rgb);
+
+			for (size_t offset = 1; offset <= 4U; offset++) {
+				memset(arena, GUARD, sizeof(arena));
+				fill_bytes(&arena[offset], len, count);
+				memcpy(expected, arena, sizeof(arena));
+
+				pixel_fade_to_black((struct led_rgb *) &arena[offset], count,
+						    amounts[a]);
+				scalar_scale(&expected[offset], len, PIXEL_OPS_ONE - amounts[a]);
+
+				zassert_mem_equal(arena, expected, sizeof(arena),
+						  "amount %u, %zu pixels at +%zu", amounts[a], count,
+						  offset);
+			}
+		}
+	}
+
+	/* A full fade reaches black, from any channel level */
+	memset(arena, UINT8_MAX, sizeof(arena));
+	for (uint32_t step = 0; step < 64U; step++) {
+		pixel_fade_to_black((struct led_rgb *) arena, SPAN_MAX, 32U);
+	}
+	memset(expected, 0, sizeof(expected));
+	zassert_mem_equal(arena, expected, SPAN_MAX * sizeof(struct led_rgb));
+}
+
+ZTEST(pixel_ops, test_add_saturate_matches_scalar)
+{
+	for (size_t count = 0; count < SPAN_MAX; count++) {
+		const size_t len = count * sizeof(struct led_rgb);
+
+		for (size_t offset = 1; offset <= 4U; offset++) {
+			for (size_t other_offset = 1; other_offset <= 4U; other_offset++) {
+				memset(arena, GUARD, sizeof(arena));
+				fill_bytes(&arena[offset], len, count);
+				fill_bytes(&other[other_offset], len, count + 3U);
+				memcpy(expected, arena, sizeof(arena));
+
+				pixel_add_saturate((struct led_rgb *) &arena[offset],
+						   (const struct led_rgb *) &other[other_offset],
+						   count);
+				scalar_add_saturate(&expected[offset], &other[other_offset], len);
+
+				zassert_mem_equal(arena, expected, sizeof(arena),
+						  "%zu pixels at +%zu/+%zu", count, offset,
+						  other_offset);
+			}
+		}
+	}
+
+	/* Every pair of channel values, through the word loop only: four aligned pixels */
+	for (uint32_t a = 0; a <= UINT8_MAX; a++) {
+		for (uint32_t b = 0; b <= UINT8_MAX; b += 4U * sizeof(struct led_rgb)) {
+			const size_t len = 4U * sizeof(struct led_rgb);
+
+			for (size_t i = 0; i < len; i++) {
+				arena[i] = a;
+				other[i] = (uint8_t)(b + i);
+			}
+			memcpy(expected, arena, len);
+
+			pixel_add_saturate((struct led_rgb *) arena, (const struct led_rgb *) other,
+					   4U);
+			scalar_add_saturate(expected, other, len);
+
+			zassert_mem_equal(arena, expected, len, "%u + %u", a, b);
+		}
+	}
+}
+
+static const struct led_rgb bench_color = { .r = 0x12U, .g = 0xEDU, .b = 0x80U };
+
+static void bench_fill(void)
+{
+	pixel_fill(bench_pixels, BENCH_PIXELS, bench_color);
+}
+
+static void bench_scalar_fill(void)
+{
+	scalar_fill((uint8_t *) bench_pixels, BENCH_PIXELS, &bench_color, sizeof(bench_color));
+}
+
+static void bench_scale(void)
+{
+	pixel_scale(bench_pixels, BENCH_PIXELS, 200U);
+}
+
+static void bench_scalar_scale(void)
+{
+	scalar_scale((uint8_t *) bench_pixels, sizeof(bench_pixels), 200U);
+}
+
+static void bench_fade_to_black(void)
+{
+	pixel_fade_to_black(bench_pixels, BENCH_PIXELS, 16U);
+}
+
+static void bench_scalar_fade_to_black(void)
+{
+	scalar_scale((uint8_t *) bench_pixels, sizeof(bench_pixels), PIXEL_OPS_ONE - 16U);
+}
+
+static void bench_blend(void)
+{
+	pixel_blend(bench_pixels, bench_other, BENCH_PIXELS, 128U);
+}
+
+static void bench_scalar_blend(void)
+{
+	scalar_blend((uint8_t *) bench_pixels, (const uint8_t *) bench_other,
+		     sizeof(bench_pixels), 128U);
+}
+
+static void bench_add_saturate(void)
+{
+	pixel_add_saturate(bench_pixels, bench_other, BENCH_PIXELS);
+}
+
+static void bench_scalar_add_saturate(void)
+{
+	scalar_add_saturate((uint8_t *) bench_pixels, (const uint8_t *) bench_other,
+			    sizeof(bench_pixels));
+}
+
+static const struct bench_op bench_ops[] = {
+	{ "fill", bench_fill, bench_scalar_fill },
+	{ "scale", bench_scale, bench_scalar_scale },
+	{ "fade to black", bench_fade_to_black, bench_scalar_fade_to_black },
+	{ "blend", bench_blend, bench_scalar_blend },
+	{ "saturating add", bench_add_saturate, bench_scalar_add_saturate },
+};
+
+/* Time one operation, in ps per LED */
+static uint64_t bench_run(void (*op)(void))
+{
+	uint64_t begin;
+
+	fill_bytes((uint8_t *) bench_pixels, sizeof(bench_pixels), 1U);
+	fill_bytes((uint8_t *) bench_other, sizeof(bench_other), 2U);
+
+	begin = bench_now_ns();
+	for (uint32_t round = 0; round < BENCH_ROUNDS; round++) {
+		op();
+		compiler_barrier();
+	}
+
+	return (bench_now_ns() - begin) * 1000U / (BENCH_ROUNDS * BENCH_PIXELS);
+}
+
+/* The host compiler may vectorize the scalar loops, which the RISC-V cores cannot */
+ZTEST(pixel_ops, test_benchmark)
+{
+	for (size_t i = 0; i < ARRAY_SIZE(bench_ops); i++) {
+		const uint64_t scalar_ps = bench_run(bench_ops[i].scalar);
+		const uint64_t ps = bench_run(bench_ops[i].swar);
+
+		TC_PRINT("%u LEDs, %s per LED: scalar %llu ps, SWAR %llu ps\n", BENCH_PIXELS,
+			 bench_ops[i].name, (unsigned long long)scalar_ps, (unsigned long long)ps);
+	}
+}
+
+ZTEST_SUITE(pixel_ops, NULL, NULL, NULL, NULL, NULL);
@@ -0,0 +1,142 @@
+/*
+ * Copyright (c) 2024 Romain Pelletant
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#include <zephyr/kernel.h>
+#include <zephyr/ztest.h>
+
+#include <led_player/ramp.h>
+
+/* Frames of exactly 1/64 s, ramps end on a frame */
+#define FRAMES_PER_SEC		64U
+#define FRAME_DELTA		(FRAME_TIME_ONE / FRAMES_PER_SEC)
+#define RAMP_MS			1000U
+
+/* Ramp from 0 to RAMP_PROGRESS_ONE: its value is the eased progress */
+static void ramp_progress_init(struct ramp *ramp, enum ramp_easing easing)
+{
+	ramp_init(ramp, ramp_lerp_scalar, 0U);
+	ramp_set_target(ramp, RAMP_PROGRESS_ONE, RAMP_MS, easing);
+}
+
+/* Eased progress at half the duration */
+static uint32_t ramp_progress_half(enum ramp_easing easing)
+{
+	struct ramp ramp;
+
+	ramp_progress_init(&ramp, easing);
+	for (uint32_t frame = 0; frame < FRAMES_PER_SEC / 2U; frame++) {
+		ramp_step(&ramp, FRAME_DELTA);
+	}
+
+	return ramp.value;
+}
+
+ZTEST(ramp, test_lerp_scalar)
+{
+	zassert_equal(ramp_lerp_scalar(10U, 250U, 0U), 10U);
+	zassert_equal(ramp_lerp_scalar(10U, 250U, RAMP_PROGRESS_ONE), 250U);
+	zassert_equal(ramp_lerp_scalar(10U, 250U, RAMP_PROGRESS_ONE / 2U), 130U);
+
+	/* Downward ramps do not wrap */
+	zassert_equal(ramp_lerp_scalar(250U, 10U, 0U), 250U);
+	zassert_equal(ramp_lerp_scalar(250U, 10U, RAMP_PROGRESS_ONE), 10U);
+	zassert_equal(ramp_lerp_scalar(250U, 10U, RAMP_PROGRESS_ONE / 2U), 130U);
+
+	zassert_equal(ramp_lerp_scalar(0U, UINT32_MAX, RAMP_PROGRESS_ONE), UINT32_MAX);
+}
+
+ZTEST(ramp, test_lerp_rgb_channels_apart)
+{
+	zassert_equal(ramp_lerp_rgb(0x00FF00U, 0xFF0000U, 0U), 0x00FF00U);
+	zassert_equal(ramp_lerp_rgb(0x00FF00U, 0xFF0000U, RAMP_PROGRESS_ONE), 0xFF0000U);
+	/* No borrow nor carry from one channel into the next */
+	zassert_equal(ramp_lerp_rgb(0x00FF00U, 0xFF0000U, RAMP_PROGRESS_ONE / 2U), 0x7F8000U);
+	zassert_equal(ramp_lerp_rgb(0x0000FFU, 0x00FF00U, RAMP_PROGRESS_ONE / 2U), 0x007F80U);
+	zassert_equal(ramp_lerp_rgb(0xFFFFFFU, 0x000000U, RAMP_PROGRESS_ONE / 2U), 0x808080U);
+}
+
+ZTEST(ramp, test_easings_reach_target_monotonic)
+{
+	for (enum ramp_easing easing = 0; easing < RAMP_EASING_COUNT; easing++) {
+		struct ramp ramp;
+		uint32_t previous = 0U;
+
+		ramp_progress_init(&ramp, easing);
+
+		for (uint32_t frame = 0; frame < FRAMES_PER_SEC * RAMP_MS / MSEC_PER_SEC; frame++) {
+			ramp_step(&ramp, FRAME_DELTA);
+			zassert_true(ramp.value >= previous, "easing %d went back at frame %u",
+				     easing, frame);
+			previous = ramp.value;
+		}
+
+		zassert_equal(ramp.value, RAMP_PROGRESS_ONE, "easing %d", easing);
+		zassert_false(ramp_step(&ramp, FRAME_DELTA), "easing %d moved past its end",
+			      easing);
+	}
+}
+
+ZTEST(ramp, test_easing_shapes)
+{
+	const uint32_t half = RAMP_PROGRESS_ONE / 2U;
+
+	zassert_equal(ramp_progress_half(RAMP_EASING_LINEAR), half);
+	/* t^2 and 1 - (1 - t)^2 */
+	zassert_equal(ramp_progress_half(RAMP_EASING_EASE_IN), half / 2U);
+	zassert_equal(ramp_progress_half(RAMP_EASING_EASE_OUT), half + half / 2U);
+	/* Smoothstep is symmetric around its middle */
+	zassert_equal(ramp_progress_half(RAMP_EASING_EASE_IN_OUT), half);
+}
+
+ZTEST(ramp, test_zero_duration_jumps)
+{
+	struct ramp ramp;
+
+	ramp_init(&ramp, ramp_lerp_scalar, 20U);
+	zassert_false(ramp_step(&ramp, FRAME_DELTA), "ramp at rest changed");
+
+	ramp_set_target(&ramp, 200U, 0U, RAMP_EASING_LINEAR);
+	zassert_true(ramp_step(&ramp, 0U));
+	zassert_equal(ramp.value, 200U);
+	zassert_false(ramp_step(&ramp, FRAME_DELTA));
+}
+
+ZTEST(ramp, test_retarget_does_not_jump)
+{
+	struct ramp ramp;
+	uint32_t value;
+
+	ramp_init(&ramp, ramp_lerp_scalar, 0U);
+	ramp_set_target(&ramp, 1000U, RAMP_MS, RAMP_EASING_LINEAR);
+	for (uint32_t frame = 0; frame < FRAMES_PER_SEC / 4U; frame++) {
+		ramp_step(&ramp, FRAME_DELTA);
+	}
+	value = ramp.value;
+	zassert_within(value, 250U, 1U);
+
+	/* Turned back midway: the ramp restarts from where it is */
+	ramp_set_target(&ramp, 0U, RAMP_MS, RAMP_EASING_LINEAR);
+	zassert_equal(ramp.value, value);
+	ramp_step(&ramp, FRAME_DELTA);
+	zassert_true(ramp.value < value && value - ramp.value <= 3U, "%u to %u", value,
+		     ramp.value);
+}
+
+ZTEST(ramp, test_duration_clamped)
+{
+	struct ramp ramp;
+
+	ramp_init(&ramp, ramp_lerp_scalar, 0U);
+	ramp_set_target(&ramp, 100U, 10U * RAMP_DURATION_MAX_MS, RAMP_EASING_LINEAR);
+
+	for (uint32_t frame = 0; frame < FRAMES_PER_SEC * RAMP_DURATION_MAX_MS / MSEC_PER_SEC;
+	     frame++) {
+		ramp_step(&ramp, FRAME_DELTA);
+	}
+
+	zassert_equal(ramp.value, 100U, "still %u after RAMP_DURATION_MAX_MS", ramp.value);
+}
+
+ZTEST_SUITE(ramp, NULL, NULL, NULL, NULL, NULL);
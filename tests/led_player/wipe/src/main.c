@@ -0,0 +1,162 @@
+/*
+ * Copyright (c) 2024 Romain Pelletant
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#include <zephyr/kernel.h>
+#include <zephyr/ztest.h>
+#include <string.h>
+
+#include <led_player/pattern/generic.h>
+#include <led_player/brightness.h>
+
+#define STRIP_LENGTH		40U
+#define FRAMES			500U
+
+static const struct pattern_descriptor *wipe;
+static uint8_t brightness[BRIGHTNESS_LUT_SIZE];
+static struct frame_context ctx;
+static struct led_rgb previous[STRIP_LENGTH];
+static struct led_rgb frame[STRIP_LENGTH];
+
+/* Frame times of a player running late now and then, in Q16.16 seconds */
+static const uint32_t deltas[] = {
+	FRAME_TIME_ONE / 50U, FRAME_TIME_ONE / 60U, FRAME_TIME_ONE / 7U,
+	FRAME_TIME_ONE / 50U, FRAME_TIME_ONE / 3U, FRAME_TIME_ONE / 50U,
+};
+
+static void render(struct led_rgb *pixels, size_t count)
+{
+	ctx.start = 0U;
+	ctx.count = count;
+	wipe->pattern_process(pixels, &ctx);
+}
+
+static void *wipe_setup(void)
+{
+	for (size_t i = 0; i < pattern_count(); i++) {
+		if (strcmp(pattern_get(i)->name, "wipe") == 0) {
+			wipe = pattern_get(i);
+		}
+	}
+	zassert_not_null(wipe);
+
+	for (size_t i = 0; i < BRIGHTNESS_LUT_SIZE; i++) {
+		brightness[i] = i;
+	}
+
+	return NULL;
+}
+
+static void wipe_before(void *fixture)
+{
+	ARG_UNUSED(fixture);
+
+	wipe->deinit();
+	zassert_ok(wipe->init(0U));
+
+	memset(&ctx, 0, sizeof(ctx));
+	ctx.color = 0x40C020U;
+	ctx.brightness = brightness;
+	ctx.led_numbers = STRIP_LENGTH;
+	render(previous, STRIP_LENGTH);
+}
+
+ZTEST(wipe, test_dirty_covers_changes)
+{
+	static const uint8_t speeds[] = { 1U, 20U, 90U, 255U };
+	size_t prefixes = 0U;
+
+	for (size_t s = 0; s < ARRAY_SIZE(speeds); s++) {
+		ctx.speed = speeds[s];
+
+		for (uint32_t f = 0; f < FRAMES; f++) {
+			size_t changed = 0U;
+			size_t dirty;
+
+			ctx.delta = deltas[f % ARRAY_SIZE(deltas)];
+			ctx.time += ctx.delta;
+			wipe->advance(&ctx);
+			dirty = wipe->dirty(&ctx);
+			render(frame, STRIP_LENGTH);
+
+			for (size_t i = 0; i < STRIP_LENGTH; i++) {
+				if (memcmp(&frame[i], &previous[i], sizeof(frame[i])) != 0) {
+					changed = i + 1U;
+				}
+			}
+
+			/* Pixels past the head sent keep their color on the strip */
+			zassert_true(changed <= dirty, "speed %u frame %u: %zu changed, %zu dirty",
+				     speeds[s], f, changed, dirty);
+			zassert_true(dirty <= STRIP_LENGTH);
+			if (dirty > 0U && dirty < STRIP_LENGTH) {
+				prefixes++;
+			}
+
+			memcpy(previous, frame, sizeof(previous));
+		}
+	}
+
+	/* Most frames only send their head */
+	zassert_true(prefixes > ARRAY_SIZE(speeds) * FRAMES / 2U, "%zu prefix frames",
+		     prefixes);
+}
+
+ZTEST(wipe, test_runs_match_process)
+{
+	struct led_strip_run runs[PATTERN_RUNS_MAX];
+	struct led_rgb expanded[STRIP_LENGTH];
+
+	ctx.speed = 7U;
+	ctx.delta = FRAME_TIME_ONE / 3U;
+
+	for (uint32_t f = 0; f < 3U * STRIP_LENGTH; f++) {
+		wipe->advance(&ctx);
+
+		/* Heads of every length, as the player renders them */
+		for (size_t head = 1U; head <= STRIP_LENGTH; head++) {
+			size_t num_runs;
+			size_t len = 0U;
+
+			render(frame, head);
+			num_runs = wipe->runs(runs, ARRAY_SIZE(runs), &ctx);
+			zassert_true(num_runs > 0U && num_runs <= ARRAY_SIZE(runs));
+
+			for (size_t r = 0; r < num_runs; r++) {
+				zassert_true(runs[r].length > 0U);
+				zassert_true(len + runs[r].length <= head);
+				for (size_t i = 0; i < runs[r].length; i++) {
+					expanded[len++] = runs[r].color;
+				}
+			}
+
+			zassert_equal(len, head, "frame %u: runs of %zu pixels", f, len);
+			zassert_mem_equal(expanded, frame, head * sizeof(frame[0]), "frame %u", f);
+		}
+	}
+}
+
+ZTEST(wipe, test_shorter_strip_starts_over)
+{
+	size_t dirty;
+
+	/* Front near the end of the strip */
+	ctx.speed = 30U;
+	ctx.delta = FRAME_TIME_ONE;
+	wipe->advance(&ctx);
+	zassert_equal(wipe->dirty(&ctx), 30U);
+
+	ctx.led_numbers = 10U;
+	ctx.speed = 4U;
+	wipe->advance(&ctx);
+	dirty = wipe->dirty(&ctx);
+	zassert_equal(dirty, 4U);
+
+	render(frame, 10U);
+	for (size_t i = 0; i < 10U; i++) {
+		zassert_equal(frame[i].g, i < dirty ? 0xC0U : 0U, "pixel %zu", i);
+	}
+}
+
+ZTEST_SUITE(wipe, NULL, wipe_setup, wipe_before, NULL, NULL);
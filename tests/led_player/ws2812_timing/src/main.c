@@ -0,0 +1,184 @@
+/*
+ * Copyright (c) 2024 Romain Pelletant
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#include <zephyr/kernel.h>
+#include <zephyr/ztest.h>
+#include <string.h>
+
+#include <led_player/backend/ws2812_timing.h>
+
+/* ESP32-C6 SPI controller, as in the app defaults */
+#define SRC_CLOCK_HZ		80000000U
+#define MAX_FREQUENCY_HZ	6400000U
+#define MARGIN_NS		50U
+
+#define BYTES			48U
+#define PULSES			(BYTES * 8U)
+
+static uint8_t bytes[BYTES];
+static uint8_t buf[BYTES * 8U];
+static uint8_t read_back[BYTES];
+static struct ws2812_pulse pulses[PULSES];
+
+static const struct ws2812_bus_limits limits = {
+	.src_clock = SRC_CLOCK_HZ,
+	.max_frequency = MAX_FREQUENCY_HZ,
+	.margin_ns = MARGIN_NS,
+};
+
+static const struct ws2812_timing_spec *spec_get(const char *name)
+{
+	for (size_t i = 0; i < ws2812_timing_spec_count; i++) {
+		if (strcmp(ws2812_timing_specs[i].name, name) == 0) {
+			return &ws2812_timing_specs[i];
+		}
+	}
+
+	return NULL;
+}
+
+static void fill_bytes(uint32_t seed)
+{
+	for (size_t i = 0; i < BYTES; i++) {
+		bytes[i] = (uint8_t)(i * 37U + seed * 11U);
+	}
+	/* Runs of both symbols */
+	bytes[0] = 0x00U;
+	bytes[1] = 0xFFU;
+}
+
+/*
+ * Encode, decode and check: the bits read back must be the ones encoded.
+ * Returns the ws2812_timing_check() result, or a negative errno if decoding
+ * does not give one pulse per bit.
+ */
+static int round_trip(const struct ws2812_timing_spec *spec, const struct ws2812_encoding *enc)
+{
+	int count;
+
+	ws2812_timing_encode(enc, bytes, BYTES, buf);
+
+	count = ws2812_timing_decode(buf, BYTES * enc->frame_bits, enc->frequency, pulses,
+				     ARRAY_SIZE(pulses));
+	if (count != PULSES) {
+		return count < 0 ? count : -EMSGSIZE;
+	}
+
+	memset(read_back, 0, sizeof(read_back));
+
+	return ws2812_timing_check(spec, pulses, count, read_back);
+}
+
+ZTEST(ws2812_timing, test_bus_frequency)
+{
+	/* Packed frames run at frame_bits times 800 kHz, 8-bit ones as requested */
+	zassert_equal(ws2812_timing_bus_frequency(3U, MAX_FREQUENCY_HZ, 0U), 2400000U);
+	zassert_equal(ws2812_timing_bus_frequency(4U, MAX_FREQUENCY_HZ, 0U), 3200000U);
+	zassert_equal(ws2812_timing_bus_frequency(8U, MAX_FREQUENCY_HZ, 0U), MAX_FREQUENCY_HZ);
+
+	/* The controller divides its source clock and rounds the rate down */
+	zassert_equal(ws2812_timing_bus_frequency(3U, MAX_FREQUENCY_HZ, SRC_CLOCK_HZ),
+		      SRC_CLOCK_HZ / 34U);
+	zassert_equal(ws2812_timing_bus_frequency(8U, MAX_FREQUENCY_HZ, SRC_CLOCK_HZ),
+		      SRC_CLOCK_HZ / 13U);
+	zassert_equal(ws2812_timing_bus_frequency(8U, 8000000U, SRC_CLOCK_HZ), 8000000U);
+}
+
+ZTEST(ws2812_timing, test_every_spec_tunes_and_round_trips)
+{
+	for (size_t i = 0; i < ws2812_timing_spec_count; i++) {
+		const struct ws2812_timing_spec *spec = &ws2812_timing_specs[i];
+		struct ws2812_encoding enc;
+
+		zassert_ok(ws2812_timing_tune(spec, &limits, &enc), "%s", spec->name);
+		TC_PRINT("%s: %u-bit frames one 0x%02x zero 0x%02x at %u Hz\n", spec->name,
+			 enc.frame_bits, enc.one_frame, enc.zero_frame, enc.frequency);
+
+		/* The tuned clock is one the controller reaches */
+		zassert_equal(enc.frequency, SRC_CLOCK_HZ / (SRC_CLOCK_HZ / enc.frequency),
+			      "%s: %u Hz", spec->name, enc.frequency);
+
+		for (uint32_t seed = 0; seed < 4U; seed++) {
+			fill_bytes(seed);
+			zassert_equal(round_trip(spec, &enc), -1, "%s: seed %u", spec->name, seed);
+			zassert_mem_equal(read_back, bytes, BYTES, "%s: seed %u", spec->name, seed);
+		}
+	}
+}
+
+ZTEST(ws2812_timing, test_tune_prefers_packed_frames)
+{
+	const struct ws2812_timing_spec *spec = spec_get("ws2812b");
+	struct ws2812_encoding enc;
+
+	zassert_not_null(spec);
+	zassert_ok(ws2812_timing_tune(spec, &limits, &enc));
+
+	/* The board encoding: three SPI bits per WS2812 bit */
+	zassert_equal(enc.frame_bits, 3U);
+	zassert_equal(enc.one_frame, 0x6U);
+	zassert_equal(enc.zero_frame, 0x4U);
+}
+
+ZTEST(ws2812_timing, test_check_flags_first_bad_pulse)
+{
+	const struct ws2812_timing_spec *ws2812b = spec_get("ws2812b");
+	const struct ws2812_timing_spec *sk6812 = spec_get("sk6812");
+	/* 3-bit frames at exactly 2.4 MHz: a one is 833 ns high */
+	const struct ws2812_encoding enc = {
+		.frequency = ws2812_timing_bus_frequency(3U, 0U, 0U),
+		.frame_bits = 3U,
+		.one_frame = 0x6U,
+		.zero_frame = 0x4U,
+	};
+
+	zassert_not_null(ws2812b);
+	zassert_not_null(sk6812);
+
+	memset(bytes, 0, sizeof(bytes));
+	bytes[2] = 0x20U;
+
+	zassert_equal(round_trip(ws2812b, &enc), -1);
+	zassert_mem_equal(read_back, bytes, BYTES);
+
+	/* Too long for a SK6812 one: the first one bit is the first failure */
+	zassert_equal(round_trip(sk6812, &enc), 2 * 8 + 2);
+}
+
+ZTEST(ws2812_timing, test_tune_fails_without_encoding)
+{
+	/* Bounds no pulse can meet */
+	const struct ws2812_timing_spec impossible = {
+		.name = "impossible",
+		.t0h_min = 500U, .t0h_max = 100U, .t0l_min = 700U, .t0l_max = 1000U,
+		.t1h_min = 650U, .t1h_max = 950U, .t1l_min = 300U, .t1l_max = 600U,
+		.reset_min_us = 280U,
+	};
+	struct ws2812_encoding enc;
+
+	zassert_equal(ws2812_timing_tune(&impossible, &limits, &enc), -ENOENT);
+}
+
+ZTEST(ws2812_timing, test_decode)
+{
+	/* One 0x6 then 0x4 3-bit frame after an idle byte: 110 100 */
+	const uint8_t frame[] = { 0x00U, 0xD0U };
+	struct ws2812_pulse decoded[2];
+
+	zassert_equal(ws2812_timing_decode(frame, sizeof(frame), 2400000U, decoded,
+					   ARRAY_SIZE(decoded)), 2);
+	zassert_equal(decoded[0].high_ns, 833U);
+	zassert_equal(decoded[0].low_ns, 416U);
+	zassert_equal(decoded[1].high_ns, 416U);
+	/* The last low time stops with the buffer */
+	zassert_equal(decoded[1].low_ns, 1666U);
+
+	zassert_equal(ws2812_timing_decode(frame, sizeof(frame), 2400000U, decoded, 1U),
+		      -ENOSPC);
+	zassert_equal(ws2812_timing_decode(frame, sizeof(frame), 0U, decoded,
+					   ARRAY_SIZE(decoded)), -EINVAL);
+}
+
+ZTEST_SUITE(ws2812_timing, NULL, NULL, NULL, NULL, NULL);